@@ -390,6 +390,11 @@ int8_t AM_fix_get_gain_diff()
     return currentGainDiff;
 }
 
+unsigned int AM_fix_get_gain_index(const unsigned vfo)
+{
+    return gain_table_index[vfo];
+}
+
 void AM_fix_enable(bool on)
 {
     enabled = on;
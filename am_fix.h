@@ -28,6 +28,7 @@
         void AM_fix_print_data(const unsigned vfo, char *s);
     #endif
     int8_t AM_fix_get_gain_diff();
+    unsigned int AM_fix_get_gain_index(const unsigned vfo);
     void AM_fix_enable(bool on);
 
 #endif
@@ -39,6 +39,7 @@
 #include "driver/backlight.h"
 #include "functions.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/inputbox.h"
 #include "ui/ui.h"
@@ -62,6 +63,10 @@ inline static void ACTION_1750() { ACTION_AlarmOr1750(true); };
 
 inline static void ACTION_ScanRestart() { ACTION_Scan(true); };
 
+#ifdef ENABLE_PROFILER
+inline static void ACTION_Profiler() { gRequestDisplayScreen = DISPLAY_PROFILER; };
+#endif
+
 void (*action_opt_table[])(void) = {
     [ACTION_OPT_NONE] = &FUNCTION_NOP,
     [ACTION_OPT_POWER] = &ACTION_Power,
@@ -130,6 +135,9 @@ void (*action_opt_table[])(void) = {
     [ACTION_OPT_REGA_ALARM] = &ACTION_RegaAlarm,
     [ACTION_OPT_REGA_TEST] = &ACTION_RegaTest,
 #endif
+#ifdef ENABLE_PROFILER
+    [ACTION_OPT_PROFILER] = &ACTION_Profiler,
+#endif
 };
 
 static_assert(ARRAY_SIZE(action_opt_table) == ACTION_OPT_LEN);
@@ -165,14 +173,14 @@ void ACTION_Monitor(void)
     gMonitor = false;
 
     if (gScanStateDir != SCAN_OFF) {
-        gScanPauseDelayIn_10ms = scan_pause_delay_in_1_10ms;
+        TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_1_10ms);
         gScheduleScanListen    = false;
         gScanPauseMode         = true;
     }
 
 #ifdef ENABLE_NOAA
     if (gEeprom.DUAL_WATCH == DUAL_WATCH_OFF && gIsNoaaMode) {
-        gNOAA_Countdown_10ms = NOAA_countdown_10ms;
+        TIMER_Arm(TIMER_NOAA, NOAA_countdown_10ms);
         gScheduleNOAA        = false;
     }
 #endif
@@ -242,7 +250,7 @@ void ACTION_Scan(bool bRestart)
 
         // jump to the next channel
         CHFRSCANNER_Start(false, gScanStateDir);
-        gScanPauseDelayIn_10ms = 1;
+        TIMER_Arm(TIMER_SCAN_PAUSE, 1);
         gScheduleScanListen    = false;
     } else {
         #ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
@@ -129,12 +129,8 @@ void AIRCOPY_StorePacket(void)
         return;
     }
 
-    const uint16_t *pData = &g_FSK_Buffer[2];
-    for (unsigned int i = 0; i < 8; i++) {
-        EEPROM_WriteBuffer(Offset, pData);
-        pData += 4;
-        Offset += 8;
-    }
+    EEPROM_WritePage(Offset, &g_FSK_Buffer[2], 64);
+    Offset += 64;
 
     if (Offset == 0x1E00) {
         gAircopyState = AIRCOPY_COMPLETE;
@@ -36,6 +36,7 @@
 #include "app/generic.h"
 #include "app/main.h"
 #include "app/menu.h"
+#include "app/profiler.h"
 #include "app/scanner.h"
 #ifdef ENABLE_UART
     #include "app/uart.h"
@@ -52,10 +53,17 @@
     #include "driver/bk1080.h"
 #endif
 #include "driver/bk4819.h"
+#include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
 #include "driver/system.h"
+#ifdef ENABLE_TICKLESS_IDLE
+    #include "driver/systick.h"
+#endif
+#ifdef ENABLE_UART
+    #include "driver/uart.h"
+#endif
 #include "dtmf.h"
 #include "external/printf/printf.h"
 #include "frequencies.h"
@@ -63,6 +71,10 @@
 #include "helper/battery.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
+#ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
+    #include "screenshot.h"
+#endif
 #include "settings.h"
 
 #if defined(ENABLE_OVERLAY)
@@ -94,6 +106,10 @@ void (*ProcessKeysFunctions[])(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 #ifdef ENABLE_AIRCOPY
     [DISPLAY_AIRCOPY] = &AIRCOPY_ProcessKeys,
 #endif
+
+#ifdef ENABLE_PROFILER
+    [DISPLAY_PROFILER] = &PROFILER_ProcessKeys,
+#endif
 };
 
 #ifdef ENABLE_REGA
@@ -118,7 +134,7 @@ static void CheckForIncoming(void)
             #ifdef ENABLE_NOAA
                 if (gIsNoaaMode)
                 {
-                    gNOAA_Countdown_10ms = NOAA_countdown_3_10ms;
+                    TIMER_Arm(TIMER_NOAA, NOAA_countdown_3_10ms);
                     gScheduleNOAA        = false;
                 }
             #endif
@@ -144,7 +160,7 @@ static void CheckForIncoming(void)
             return;
         }
 
-        gDualWatchCountdown_10ms = dual_watch_count_after_rx_10ms;
+        TIMER_Arm(TIMER_DUAL_WATCH, dual_watch_count_after_rx_10ms);
         gScheduleDualWatch       = false;
 
         // let the user see DW is not active
@@ -163,7 +179,7 @@ static void CheckForIncoming(void)
             return;
         }
 
-        gScanPauseDelayIn_10ms = scan_pause_delay_in_3_10ms;
+        TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_3_10ms);
         gScheduleScanListen    = false;
     }
 
@@ -193,8 +209,8 @@ static void HandleIncoming(void)
     bool bFlag = (gScanStateDir == SCAN_OFF && gCurrentCodeType == CODE_TYPE_OFF);
 
 #ifdef ENABLE_NOAA
-    if (IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE) && gNOAACountdown_10ms > 0) {
-        gNOAACountdown_10ms = 0;
+    if (IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE) && TIMER_Remaining(TIMER_NOAA_HOLD) > 0) {
+        TIMER_Stop(TIMER_NOAA_HOLD);
         bFlag               = true;
     }
 #endif
@@ -221,7 +237,7 @@ static void HandleIncoming(void)
             if (gRxReceptionMode != RX_MODE_DETECTED) {
                 return;
             }
-            gDualWatchCountdown_10ms = dual_watch_count_after_1_10ms;
+            TIMER_Arm(TIMER_DUAL_WATCH, dual_watch_count_after_1_10ms);
             gScheduleDualWatch       = false;
 
             gRxReceptionMode = RX_MODE_LISTENING;
@@ -269,7 +285,7 @@ static void HandleReceive(void)
             break;
 
         case CODE_TYPE_CONTINUOUS_TONE:
-            if (gFoundCTCSS && gFoundCTCSSCountdown_10ms == 0)
+            if (gFoundCTCSS && TIMER_Remaining(TIMER_FOUND_CTCSS) == 0)
             {
                 gFoundCTCSS = false;
                 gFoundCDCSS = false;
@@ -280,7 +296,7 @@ static void HandleReceive(void)
 
         case CODE_TYPE_DIGITAL:
         case CODE_TYPE_REVERSE_DIGITAL:
-            if (gFoundCDCSS && gFoundCDCSSCountdown_10ms == 0)
+            if (gFoundCDCSS && TIMER_Remaining(TIMER_FOUND_CDCSS) == 0)
             {
                 gFoundCTCSS = false;
                 gFoundCDCSS = false;
@@ -320,7 +336,7 @@ static void HandleReceive(void)
                     if (!gFoundCTCSS)
                     {
                         gFoundCTCSS               = true;
-                        gFoundCTCSSCountdown_10ms = 100;   // 1 sec
+                        TIMER_Arm(TIMER_FOUND_CTCSS, 100);   // 1 sec
                     }
 
                     if (g_CxCSS_TAIL_Found)
@@ -340,7 +356,7 @@ static void HandleReceive(void)
                     if (!gFoundCDCSS)
                     {
                         gFoundCDCSS               = true;
-                        gFoundCDCSSCountdown_10ms = 100;   // 1 sec
+                        TIMER_Arm(TIMER_FOUND_CDCSS, 100);   // 1 sec
                     }
 
                     if (g_CxCSS_TAIL_Found)
@@ -379,7 +395,7 @@ Skip:
 
             #ifdef ENABLE_NOAA
                 if (IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE))
-                    gNOAACountdown_10ms = 300;         // 3 sec
+                    TIMER_Arm(TIMER_NOAA_HOLD, 300);         // 3 sec
             #endif
 
             gUpdateDisplay = true;
@@ -394,7 +410,7 @@ Skip:
                         break;
 
                     case SCAN_RESUME_CO:
-                        gScanPauseDelayIn_10ms = scan_pause_delay_in_7_10ms;
+                        TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_7_10ms);
                         gScheduleScanListen    = false;
                         break;
 
@@ -412,7 +428,7 @@ Skip:
                     }
                     else
                     {
-                        gScanPauseDelayIn_10ms = gEeprom.SCAN_RESUME_MODE * (250 / 10); // 250ms
+                        TIMER_Arm(TIMER_SCAN_PAUSE, gEeprom.SCAN_RESUME_MODE * (250 / 10)); // 250ms
                         gScheduleScanListen    = false;
                     }
                 }
@@ -420,7 +436,7 @@ Skip:
                 /*
                 if(gEeprom.SCAN_RESUME_MODE < 2)
                 {
-                    gScanPauseDelayIn_10ms = scan_pause_delay_in_6_10ms + (scan_pause_delay_in_6_10ms * 24 * gEeprom.SCAN_RESUME_MODE);
+                    TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_6_10ms + (scan_pause_delay_in_6_10ms * 24 * gEeprom.SCAN_RESUME_MODE));
                     gScheduleScanListen    = false;
 
                 }
@@ -434,12 +450,12 @@ Skip:
                 switch (gEeprom.SCAN_RESUME_MODE)
                 {
                     case 0:
-                        gScanPauseDelayIn_10ms = scan_pause_delay_in_6_10ms;
+                        TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_6_10ms);
                         gScheduleScanListen    = false;
                         break;
 
                     case 1:
-                        gScanPauseDelayIn_10ms = scan_pause_delay_in_2_10ms * 5;
+                        TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_2_10ms * 5);
                         gScheduleScanListen    = false;
                         break;
 
@@ -448,7 +464,7 @@ Skip:
                         break;
 
                     //default:
-                    //    gScanPauseDelayIn_10ms = scan_pause_delay_in_5_10ms * (gEeprom.SCAN_RESUME_MODE - 1) * 5;
+                    //    TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_5_10ms * (gEeprom.SCAN_RESUME_MODE - 1) * 5);
                     //    break;
                 }
                 */
@@ -531,7 +547,7 @@ void APP_StartListening(FUNCTION_Type_t function)
         gRxVfo->pTX->Frequency      = NoaaFrequencyTable[gNoaaChannel];
         gEeprom.ScreenChannel[vfo] = gRxVfo->CHANNEL_SAVE;
 
-        gNOAA_Countdown_10ms        = 500;   // 5 sec
+        TIMER_Arm(TIMER_NOAA, 500);   // 5 sec
         gScheduleNOAA               = false;
     }
 #endif
@@ -540,7 +556,7 @@ void APP_StartListening(FUNCTION_Type_t function)
         gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
     {   // not scanning, dual watch is enabled
 
-        gDualWatchCountdown_10ms = dual_watch_count_after_2_10ms;
+        TIMER_Arm(TIMER_DUAL_WATCH, dual_watch_count_after_2_10ms);
         gScheduleDualWatch       = false;
 
         // when crossband is active only the main VFO should be used for TX
@@ -641,9 +657,9 @@ static void DualwatchAlternate(void)
     RADIO_SetupRegisters(false);
 
     #ifdef ENABLE_NOAA
-        gDualWatchCountdown_10ms = gIsNoaaMode ? dual_watch_count_noaa_10ms : dual_watch_count_toggle_10ms;
+        TIMER_Arm(TIMER_DUAL_WATCH, gIsNoaaMode ? dual_watch_count_noaa_10ms : dual_watch_count_toggle_10ms);
     #else
-        gDualWatchCountdown_10ms = dual_watch_count_toggle_10ms;
+        TIMER_Arm(TIMER_DUAL_WATCH, dual_watch_count_toggle_10ms);
     #endif
 }
 
@@ -748,12 +764,12 @@ static void CheckRadioInterrupts(void)
 
             if (gEeprom.VOX_SWITCH) {
                 if (gCurrentFunction == FUNCTION_POWER_SAVE && !gRxIdleMode) {
-                    gPowerSave_10ms            = power_save2_10ms;
+                    TIMER_Arm(TIMER_POWER_SAVE, power_save2_10ms);
                     gPowerSaveCountdownExpired = 0;
                 }
 
-                if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF && (gScheduleDualWatch || gDualWatchCountdown_10ms < dual_watch_count_after_vox_10ms)) {
-                    gDualWatchCountdown_10ms = dual_watch_count_after_vox_10ms;
+                if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF && (gScheduleDualWatch || TIMER_Remaining(TIMER_DUAL_WATCH) < dual_watch_count_after_vox_10ms)) {
+                    TIMER_Arm(TIMER_DUAL_WATCH, dual_watch_count_after_vox_10ms);
                     gScheduleDualWatch = false;
 
                     // let the user see DW is not active
@@ -841,8 +857,8 @@ static void HandleVox(void)
 
     if (gVOX_NoiseDetected) {
         if (g_VOX_Lost)
-            gVoxStopCountdown_10ms = vox_stop_count_down_10ms;
-        else if (gVoxStopCountdown_10ms == 0)
+            TIMER_Arm(TIMER_VOX_STOP, vox_stop_count_down_10ms);
+        else if (TIMER_Remaining(TIMER_VOX_STOP) == 0)
             gVOX_NoiseDetected = false;
 
         if (gCurrentFunction == FUNCTION_TRANSMIT && !gPttIsPressed && !gVOX_NoiseDetected) {
@@ -1004,6 +1020,12 @@ void APP_Update(void)
     {   // scanning
         CHFRSCANNER_ContinueScanning();
     }
+#ifdef ENABLE_SCAN_PREFETCH
+    else if (gScanStateDir != SCAN_OFF && IS_MR_CHANNEL(gNextMrChannel))
+    {   // listening to a channel, get the next one ready
+        CHFRSCANNER_Prefetch();
+    }
+#endif
 
 #ifdef ENABLE_NOAA
 #ifdef ENABLE_VOICE
@@ -1015,7 +1037,7 @@ void APP_Update(void)
             NOAA_IncreaseChannel();
             RADIO_SetupRegisters(false);
 
-            gNOAA_Countdown_10ms = 7;      // 70ms
+            TIMER_Arm(TIMER_NOAA, 7);      // 70ms
             gScheduleNOAA        = false;
         }
 #endif
@@ -1079,7 +1101,7 @@ void APP_Update(void)
             || (gIsNoaaMode && (IS_NOAA_CHANNEL(gEeprom.ScreenChannel[0]) || IS_NOAA_CHANNEL(gEeprom.ScreenChannel[1])))
 #endif
         ) {
-            gBatterySaveCountdown_10ms = battery_save_count_10ms;
+            TIMER_Arm(TIMER_BATTERY_SAVE, battery_save_count_10ms);
         } else {
             FUNCTION_Select(FUNCTION_POWER_SAVE);
         }
@@ -1113,7 +1135,7 @@ void APP_Update(void)
 
             FUNCTION_Init();
 
-            gPowerSave_10ms = power_save1_10ms; // come back here in a bit
+            TIMER_Arm(TIMER_POWER_SAVE, power_save1_10ms); // come back here in a bit
             gRxIdleMode     = false;            // RX is awake
         }
         else if (gEeprom.DUAL_WATCH == DUAL_WATCH_OFF || gScanStateDir != SCAN_OFF || gCssBackgroundScan || goToSleep)
@@ -1123,14 +1145,14 @@ void APP_Update(void)
 #ifdef ENABLE_FEAT_F4HWN_SLEEP
             if(gWakeUp)
             {
-                gPowerSave_10ms = gEeprom.BATTERY_SAVE * 200; // deep sleep now indexed on BatSav
+                TIMER_Arm(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 200); // deep sleep now indexed on BatSav
             }
             else
             {
-                gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+                TIMER_Arm(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 10);
             }
 #else
-            gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+            TIMER_Arm(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 10);
 #endif
             gRxIdleMode     = true;
             goToSleep = false;
@@ -1145,7 +1167,7 @@ void APP_Update(void)
         else {
             // toggle between the two VFO's
             DualwatchAlternate();
-            gPowerSave_10ms   = power_save1_10ms;
+            TIMER_Arm(TIMER_POWER_SAVE, power_save1_10ms);
             goToSleep = true;
         }
 
@@ -1355,23 +1377,41 @@ void APP_TimeSlice10ms(void)
 
 #ifdef ENABLE_AM_FIX
     if (gRxVfo->Modulation == MODULATION_AM) {
-        AM_fix_10ms(gEeprom.RX_VFO);
+        PROFILE(PROFILER_AM_FIX, AM_fix_10ms(gEeprom.RX_VFO));
     }
 #endif
 
 #ifdef ENABLE_UART
     if (UART_IsCommandAvailable()) {
         __disable_irq();
-        UART_HandleCommand();
+        PROFILE(PROFILER_UART_COMMAND, UART_HandleCommand());
         __enable_irq();
     }
+
+    #ifdef ENABLE_UART_TELEMETRY
+        UART_SendTelemetry();
+    #endif
+
+    #ifdef ENABLE_UART_BULK
+        UART_BulkPump();
+    #endif
+
+    #ifdef ENABLE_UART_SPECTRUM
+        UART_SpectrumPump();
+    #endif
+
+    #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
+        mirrorScreenShot();
+    #endif
 #endif
 
+    EEPROM_FlushStep();
+
     if (gReducedService)
         return;
 
     if (gCurrentFunction != FUNCTION_POWER_SAVE || !gRxIdleMode)
-        CheckRadioInterrupts();
+        PROFILE(PROFILER_RADIO_INTERRUPTS, CheckRadioInterrupts());
 
     if (gCurrentFunction == FUNCTION_TRANSMIT)
     {   // transmitting
@@ -1514,12 +1554,52 @@ void cancelUserInputModes(void)
     }
 }
 
+#ifdef ENABLE_TICKLESS_IDLE
+// keys are polled, a press shorter than this may go unseen
+#define TICKLESS_MAX_TICKS 5
+
+// nothing to do until the next tick, sleep till then. While the BK4819
+// sleeps in power save, no key is down and the UART is quiet, the SysTick
+// interrupt skips ticks until the nearest countdown is due.
+void APP_Idle(void)
+{
+    uint32_t Ticks = 1;
+
+    if (gCurrentFunction == FUNCTION_POWER_SAVE && gRxIdleMode
+        && gKeyReading0 == KEY_INVALID && gKeyReading1 == KEY_INVALID && !gPttIsPressed
+        && gSerialConfigCountDown_500ms == 0
+#ifdef ENABLE_UART
+        && UART_TxFree() == UART_TX_QUEUE_SIZE - 1
+#endif
+#ifdef ENABLE_VOICE
+        && gVoiceWriteIndex == 0
+#endif
+    ) {
+        Ticks = MIN(MIN(gSchedulerSlack_10ms, TIMER_NextDeadline()), TICKLESS_MAX_TICKS);
+    }
+
+    __disable_irq();
+    if (!gNextTimeslice)
+        SYSTICK_Sleep(Ticks);
+    __enable_irq();
+}
+#endif
+
 // this is called once every 500ms
 void APP_TimeSlice500ms(void)
 {
     gNextTimeslice_500ms = false;
     bool exit_menu = false;
 
+#ifdef ENABLE_TICKLESS_IDLE
+    gIdlePercent = SYSTICK_IdlePercent();
+#endif
+
+#ifdef ENABLE_PROFILER
+    if (gScreenToDisplay == DISPLAY_PROFILER)
+        gUpdateDisplay = true;
+#endif
+
     // Skipped authentic device check
 
     if (gKeypadLocked > 0)
@@ -1599,7 +1679,7 @@ void APP_TimeSlice500ms(void)
         //ST7565_Init();
         ST7565_FixInterfGlitch();
         BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, false);
-        gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+        TIMER_Arm(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 10);
         gWakeUp = false;
     }
 
@@ -1611,10 +1691,11 @@ void APP_TimeSlice500ms(void)
     {
         if (gSleepModeCountdown_500ms > 0 && --gSleepModeCountdown_500ms == 0) {
             gBacklightCountdown_500ms = 0;
-            gPowerSave_10ms = 1;
+            TIMER_Arm(TIMER_POWER_SAVE, 1);
             gWakeUp = true;
             PWM_PLUS0_CH0_COMP = 0;
             ST7565_ShutDown();
+            EEPROM_Flush();     // the knob is likely to be turned off next
         }
         else if(gSleepModeCountdown_500ms != 0 && gSleepModeCountdown_500ms < 21 && gSetting_set_off != 0)
         {
@@ -1646,6 +1727,8 @@ void APP_TimeSlice500ms(void)
 
         if (gBatteryCurrent > 500 || gBatteryCalibration[3] < gBatteryCurrentVoltage)
         {
+            EEPROM_Flush();
+
             #ifdef ENABLE_OVERLAY
                 overlay_FLASH_RebootToBootloader();
             #else
@@ -1823,6 +1906,11 @@ static void ALARM_Off(void)
 
 static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 {
+#ifdef ENABLE_SCAN_PREFETCH
+    // a key may change a setting the next scan channel was loaded with
+    RADIO_DropPrefetch();
+#endif
+
     #ifdef ENABLE_FEAT_F4HWN_SLEEP
     if(gWakeUp)
     {
@@ -1852,7 +1940,7 @@ static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
     if (gCurrentFunction == FUNCTION_POWER_SAVE)
         FUNCTION_Select(FUNCTION_FOREGROUND);
 
-    gBatterySaveCountdown_10ms = battery_save_count_10ms;
+    TIMER_Arm(TIMER_BATTERY_SAVE, battery_save_count_10ms);
 
     if (gEeprom.AUTO_KEYPAD_LOCK)
         gKeyLockCountdown = gEeprom.AUTO_KEYPAD_LOCK * 30;     // 15 seconds step
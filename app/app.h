@@ -30,6 +30,9 @@ uint32_t APP_SetFrequencyByStep(VFO_Info_t *pInfo, int8_t direction);
 void     APP_Update(void);
 void     APP_TimeSlice10ms(void);
 void     APP_TimeSlice500ms(void);
+#ifdef ENABLE_TICKLESS_IDLE
+    void APP_Idle(void);
+#endif
 
 #endif
 
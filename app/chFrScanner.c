@@ -3,6 +3,7 @@
 #include "app/chFrScanner.h"
 #include "functions.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 //#include "debugging.h"
 
@@ -37,6 +38,11 @@ uint8_t             initialCROSS_BAND_RX_TX;
 static void NextFreqChannel(void);
 static void NextMemChannel(void);
 
+static unsigned int prev_mr_chan = 0;
+#ifdef ENABLE_SCAN_PREFETCH
+static bool         prefetchPending;
+#endif
+
 void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_direction)
 {
     if (storeBackupSettings) {
@@ -53,6 +59,13 @@ void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_directi
 
     if (IS_MR_CHANNEL(gNextMrChannel))
     {   // channel mode
+#ifdef ENABLE_CHANNEL_CACHE
+        // make room for the scan list about to be scanned
+        SETTINGS_ClearChannelCache();
+#endif
+#ifdef ENABLE_SCAN_PREFETCH
+        RADIO_DropPrefetch();
+#endif
         if (storeBackupSettings) {
             initialFrqOrChan = gRxVfo->CHANNEL_SAVE;
             lastFoundFrqOrChan = initialFrqOrChan;
@@ -72,7 +85,7 @@ void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_directi
     lastFoundFrqOrChanOld = lastFoundFrqOrChan;
 #endif
 
-    gScanPauseDelayIn_10ms = scan_pause_delay_in_2_10ms;
+    TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_2_10ms);
     gScheduleScanListen    = false;
     gRxReceptionMode       = RX_MODE_NONE;
     gScanPauseMode         = false;
@@ -123,11 +136,11 @@ void CHFRSCANNER_Found(void)
 {
     if (gEeprom.SCAN_RESUME_MODE > 80) {
         if (!gScanPauseMode) {
-            gScanPauseDelayIn_10ms = scan_pause_delay_in_5_10ms * (gEeprom.SCAN_RESUME_MODE - 80) * 5;
+            TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_5_10ms * (gEeprom.SCAN_RESUME_MODE - 80) * 5);
             gScanPauseMode = true;
         }
     } else {
-        gScanPauseDelayIn_10ms = 0;
+        TIMER_Stop(TIMER_SCAN_PAUSE);
     }
 
     // gScheduleScanListen is always false...
@@ -138,14 +151,14 @@ void CHFRSCANNER_Found(void)
     {
         if (!gScanPauseMode)
         {
-            gScanPauseDelayIn_10ms = scan_pause_delay_in_5_10ms * (gEeprom.SCAN_RESUME_MODE - 1) * 5;
+            TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_5_10ms * (gEeprom.SCAN_RESUME_MODE - 1) * 5);
             gScheduleScanListen    = false;
             gScanPauseMode         = true;
         }
     }
     else
     {
-        gScanPauseDelayIn_10ms = 0;
+        TIMER_Stop(TIMER_SCAN_PAUSE);
         gScheduleScanListen    = false;
     }
     */
@@ -156,7 +169,7 @@ void CHFRSCANNER_Found(void)
         case SCAN_RESUME_TO:
             if (!gScanPauseMode)
             {
-                gScanPauseDelayIn_10ms = scan_pause_delay_in_1_10ms;
+                TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_1_10ms);
                 gScheduleScanListen    = false;
                 gScanPauseMode         = true;
             }
@@ -164,7 +177,7 @@ void CHFRSCANNER_Found(void)
 
         case SCAN_RESUME_CO:
         case SCAN_RESUME_SE:
-            gScanPauseDelayIn_10ms = 0;
+            TIMER_Stop(TIMER_SCAN_PAUSE);
             gScheduleScanListen    = false;
             break;
     }
@@ -194,6 +207,11 @@ void CHFRSCANNER_Stop(void)
     
     gScanStateDir = SCAN_OFF;
 
+#ifdef ENABLE_SCAN_PREFETCH
+    prefetchPending = false;
+    RADIO_DropPrefetch();
+#endif
+
     const uint32_t chFr = gScanKeepResult ? lastFoundFrqOrChan : initialFrqOrChan;
     const bool channelChanged = chFr != initialFrqOrChan;
     if (IS_MR_CHANNEL(gNextMrChannel)) {
@@ -239,31 +257,33 @@ static void NextFreqChannel(void)
     RADIO_SetupRegisters(true);
 
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
-    gScanPauseDelayIn_10ms = 9;   // 90ms
+    TIMER_Arm(TIMER_SCAN_PAUSE, 9);   // 90ms
 #else
-    gScanPauseDelayIn_10ms = scan_pause_delay_in_6_10ms;
+    TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_6_10ms);
 #endif
 
     gUpdateDisplay     = true;
 }
 
-static void NextMemChannel(void)
+// The memory channel the scan goes to after Current, and the scan list
+// state it goes on from: NextMemChannel() passes in the real state,
+// PredictMemChannel() copies of it
+static unsigned int NextMemTarget(unsigned int Current, scan_next_chan_t *pScanList, unsigned int *pPrevMr)
 {
-    static unsigned int prev_mr_chan = 0;
     const bool          enabled      = (gEeprom.SCAN_LIST_DEFAULT > 0 && gEeprom.SCAN_LIST_DEFAULT < 4) ? gEeprom.SCAN_LIST_ENABLED[gEeprom.SCAN_LIST_DEFAULT - 1] : true;
     const int           chan1        = (gEeprom.SCAN_LIST_DEFAULT > 0 && gEeprom.SCAN_LIST_DEFAULT < 4) ? gEeprom.SCANLIST_PRIORITY_CH1[gEeprom.SCAN_LIST_DEFAULT - 1] : -1;
     const int           chan2        = (gEeprom.SCAN_LIST_DEFAULT > 0 && gEeprom.SCAN_LIST_DEFAULT < 4) ? gEeprom.SCANLIST_PRIORITY_CH2[gEeprom.SCAN_LIST_DEFAULT - 1] : -1;
-    const unsigned int  prev_chan    = gNextMrChannel;
+    unsigned int        next         = Current;
     unsigned int        chan         = 0;
 
     //char str[64] = "";
 
     if (enabled)
     {
-        switch (currentScanList)
+        switch (*pScanList)
         {
             case SCAN_NEXT_CHAN_SCANLIST1:
-                prev_mr_chan = gNextMrChannel;
+                *pPrevMr = Current;
     
                 //sprintf(str, "-> Chan1 %d\n", chan1 + 1);
                 //LogUart(str);
@@ -272,8 +292,8 @@ static void NextMemChannel(void)
                 {
                     if (RADIO_CheckValidChannel(chan1, false, gEeprom.SCAN_LIST_DEFAULT))
                     {
-                        currentScanList = SCAN_NEXT_CHAN_SCANLIST1;
-                        gNextMrChannel   = chan1;
+                        *pScanList = SCAN_NEXT_CHAN_SCANLIST1;
+                        next       = chan1;
                         break;
                     }
                 }
@@ -288,8 +308,8 @@ static void NextMemChannel(void)
                 {
                     if (RADIO_CheckValidChannel(chan2, false, gEeprom.SCAN_LIST_DEFAULT))
                     {
-                        currentScanList = SCAN_NEXT_CHAN_SCANLIST2;
-                        gNextMrChannel   = chan2;
+                        *pScanList = SCAN_NEXT_CHAN_SCANLIST2;
+                        next       = chan2;
                         break;
                     }
                 }
@@ -301,8 +321,8 @@ static void NextMemChannel(void)
                 {
                     if (RADIO_CheckValidChannel(chan3, false, 0))
                     {
-                        currentScanList = SCAN_NEXT_CHAN_SCANLIST3;
-                        gNextMrChannel   = chan3;
+                        *pScanList = SCAN_NEXT_CHAN_SCANLIST3;
+                        next       = chan3;
                         break;
                     }
                 }
@@ -317,35 +337,48 @@ static void NextMemChannel(void)
 //                  chan = gEeprom.ScreenChannel[chan];
 //                  if (IS_MR_CHANNEL(chan))
 //                  {
-//                      currentScanList = SCAN_NEXT_CHAN_DUAL_WATCH;
-//                      gNextMrChannel   = chan;
+//                      *pScanList = SCAN_NEXT_CHAN_DUAL_WATCH;
+//                      next       = chan;
 //                      break;
 //                  }
 //              }
 
             default:
             case SCAN_NEXT_CHAN_MR:
-                currentScanList = SCAN_NEXT_CHAN_MR;
-                gNextMrChannel   = prev_mr_chan;
-                chan             = 0xff;
+                *pScanList = SCAN_NEXT_CHAN_MR;
+                next       = *pPrevMr;
+                chan       = 0xff;
                 break;
         }
     }
 
     if (!enabled || chan == 0xff)
     {       
-        chan = RADIO_FindNextChannel(gNextMrChannel + gScanStateDir, gScanStateDir, true, gEeprom.SCAN_LIST_DEFAULT);
+        chan = RADIO_FindNextChannel(next + gScanStateDir, gScanStateDir, true, gEeprom.SCAN_LIST_DEFAULT);
         if (chan == 0xFF)
         {   // no valid channel found
             chan = MR_CHANNEL_FIRST;
         }
         
-        gNextMrChannel = chan;
+        next = chan;
 
         //sprintf(str, "----> Chan %d\n", chan + 1);
         //LogUart(str);
     }
 
+    if (enabled)
+        if (++*pScanList >= SCAN_NEXT_NUM)
+            *pScanList = SCAN_NEXT_CHAN_SCANLIST1;  // back round we go
+
+    return next;
+}
+
+static void NextMemChannel(void)
+{
+    const unsigned int  prev_chan    = gNextMrChannel;
+
+    gNextMrChannel = NextMemTarget(gNextMrChannel, &currentScanList, &prev_mr_chan);
+
     if (gNextMrChannel != prev_chan)
     {
         gEeprom.MrChannel[    gEeprom.RX_VFO] = gNextMrChannel;
@@ -358,12 +391,35 @@ static void NextMemChannel(void)
     }
 
 #ifdef ENABLE_FASTER_CHANNEL_SCAN
-    gScanPauseDelayIn_10ms = 9;  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
+    TIMER_Arm(TIMER_SCAN_PAUSE, 9);  // 90ms .. <= ~60ms it misses signals (squelch response and/or PLL lock time) ?
 #else
-    gScanPauseDelayIn_10ms = scan_pause_delay_in_3_10ms;
+    TIMER_Arm(TIMER_SCAN_PAUSE, scan_pause_delay_in_3_10ms);
 #endif
 
-    if (enabled)
-        if (++currentScanList >= SCAN_NEXT_NUM)
-            currentScanList = SCAN_NEXT_CHAN_SCANLIST1;  // back round we go
+#ifdef ENABLE_SCAN_PREFETCH
+    prefetchPending = true;     // load the next channel while this one is listened to
+#endif
+}
+
+#ifdef ENABLE_SCAN_PREFETCH
+// the channel NextMemChannel() is going to hop to, without moving there
+static uint8_t PredictMemChannel(void)
+{
+    scan_next_chan_t scanList = currentScanList;
+    unsigned int     prevMr   = prev_mr_chan;
+
+    return NextMemTarget(gNextMrChannel, &scanList, &prevMr);
 }
+
+void CHFRSCANNER_Prefetch(void)
+{
+    if (!prefetchPending)
+        return;
+
+    prefetchPending = false;
+
+    const uint8_t chan = PredictMemChannel();
+    if (chan != 0xFF && chan != gNextMrChannel)
+        RADIO_PrefetchChannel(gEeprom.RX_VFO, chan);
+}
+#endif
@@ -19,6 +19,10 @@ void CHFRSCANNER_Found(void);
 void CHFRSCANNER_Stop(void);
 void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_direction);
 void CHFRSCANNER_ContinueScanning(void);
+#ifdef ENABLE_SCAN_PREFETCH
+// load the channel after the current one, once per hop
+void CHFRSCANNER_Prefetch(void);
+#endif
 
 #ifdef ENABLE_FEAT_F4HWN
     extern uint32_t lastFoundFrqOrChan;
@@ -42,6 +42,7 @@
 #include "frequencies.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/inputbox.h"
 #include "ui/ui.h"
@@ -67,6 +68,9 @@ static void toggle_chan_scanlist(void)
     if(gMR_ChannelExclude[gTxVfo->CHANNEL_SAVE] == true)
     {
         gMR_ChannelExclude[gTxVfo->CHANNEL_SAVE] = false;
+#ifdef ENABLE_SCAN_LIST_INDEX
+        RADIO_InvalidateScanLists();
+#endif
         return;
     }
 
@@ -130,7 +134,7 @@ static void processFKeyFunction(const KEY_Code_t Key, const bool beep)
                 if (gScanStateDir != SCAN_OFF) {
                     if (gCurrentFunction != FUNCTION_INCOMING ||
                         gRxReceptionMode == RX_MODE_NONE      ||
-                        gScanPauseDelayIn_10ms == 0)
+                        TIMER_Remaining(TIMER_SCAN_PAUSE) == 0)
                     {   // scan is running (not paused)
                         return;
                     }
@@ -674,6 +678,9 @@ static void MAIN_Key_MENU(bool bKeyPressed, bool bKeyHeld)
                 if(FUNCTION_IsRx())
                 {
                     gMR_ChannelExclude[gTxVfo->CHANNEL_SAVE] = true;
+#ifdef ENABLE_SCAN_LIST_INDEX
+                    RADIO_InvalidateScanLists();
+#endif
 
                     gVfoConfigureMode = VFO_CONFIGURE;
                     gFlagResetVfos    = true;
@@ -925,7 +932,7 @@ static void MAIN_Key_UP_DOWN(bool bKeyPressed, bool bKeyHeld, int8_t Direction)
 
     // jump to the next channel
     CHFRSCANNER_Start(false, Direction);
-    gScanPauseDelayIn_10ms = 1;
+    TIMER_Arm(TIMER_SCAN_PAUSE, 1);
     gScheduleScanListen = false;
 
     gPttWasReleased = true;
@@ -0,0 +1,85 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifdef ENABLE_PROFILER
+
+#include <string.h>
+
+#include "app/profiler.h"
+#include "misc.h"
+#include "ui/ui.h"
+
+PROFILER_Stats_t  gProfilerStats[PROFILER_N_ELEM];
+volatile uint32_t gProfilerMissedSlices;
+
+static uint32_t gProfilerSinceUs;
+
+void PROFILER_Stop(PROFILER_Id_t Id, uint32_t StartUs)
+{
+    const uint32_t    Us     = SYSTICK_GetUs() - StartUs;
+    PROFILER_Stats_t *pStats = &gProfilerStats[Id];
+
+    if (pStats->Count == 0 || Us < pStats->MinUs)
+        pStats->MinUs = Us;
+    if (Us > pStats->MaxUs)
+        pStats->MaxUs = Us;
+
+    pStats->TotalUs += Us;
+    pStats->Count++;
+}
+
+void PROFILER_Reset(void)
+{
+    memset(gProfilerStats, 0, sizeof(gProfilerStats));
+    gProfilerMissedSlices = 0;
+    gProfilerSinceUs      = SYSTICK_GetUs();
+}
+
+uint32_t PROFILER_ElapsedUs(void)
+{
+    return SYSTICK_GetUs() - gProfilerSinceUs;
+}
+
+uint8_t PROFILER_LoadPercent(void)
+{
+    // the other call sites run inside these three
+    const uint32_t Busy = gProfilerStats[PROFILER_APP_UPDATE].TotalUs +
+                          gProfilerStats[PROFILER_TIMESLICE_10MS].TotalUs +
+                          gProfilerStats[PROFILER_TIMESLICE_500MS].TotalUs;
+    const uint32_t Elapsed = PROFILER_ElapsedUs() / 100;
+
+    return Elapsed ? MIN(Busy / Elapsed, 100u) : 0;
+}
+
+void PROFILER_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
+{
+    if (bKeyHeld || !bKeyPressed)
+        return;
+
+    switch (Key) {
+    case KEY_MENU:
+        PROFILER_Reset();
+        gUpdateDisplay = true;
+        break;
+    case KEY_EXIT:
+        gRequestDisplayScreen = DISPLAY_MAIN;
+        break;
+    default:
+        break;
+    }
+}
+
+#endif
@@ -0,0 +1,72 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef APP_PROFILER_H
+#define APP_PROFILER_H
+
+#ifdef ENABLE_PROFILER
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/keyboard.h"
+#include "driver/systick.h"
+
+typedef enum {
+    PROFILER_APP_UPDATE,
+    PROFILER_TIMESLICE_10MS,
+    PROFILER_TIMESLICE_500MS,
+    PROFILER_DISPLAY_SCREEN,
+    PROFILER_RADIO_INTERRUPTS,
+    PROFILER_AM_FIX,
+    PROFILER_UART_COMMAND,
+    PROFILER_N_ELEM
+} PROFILER_Id_t;
+
+// microseconds, TotalUs wraps after 71 minutes of run time in one call site
+typedef struct {
+    uint32_t Count;
+    uint32_t TotalUs;
+    uint32_t MinUs;
+    uint32_t MaxUs;
+} PROFILER_Stats_t;
+
+extern PROFILER_Stats_t gProfilerStats[PROFILER_N_ELEM];
+// 10 ms slices the main loop never got to, see SystickHandler()
+extern volatile uint32_t gProfilerMissedSlices;
+
+void     PROFILER_Stop(PROFILER_Id_t Id, uint32_t StartUs);
+void     PROFILER_Reset(void);
+// microseconds since PROFILER_Reset()
+uint32_t PROFILER_ElapsedUs(void);
+// time in the top-level main loop calls since PROFILER_Reset()
+uint8_t  PROFILER_LoadPercent(void);
+void     PROFILER_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld);
+
+#define PROFILE(Id, Call)                               \
+    do {                                                \
+        const uint32_t ProfileStartUs = SYSTICK_GetUs(); \
+        Call;                                           \
+        PROFILER_Stop(Id, ProfileStartUs);              \
+    } while (0)
+
+#else
+
+#define PROFILE(Id, Call) Call
+
+#endif
+
+#endif
@@ -35,6 +35,11 @@
 #include "driver/eeprom.h"
 #endif
 
+#ifdef ENABLE_UART_SPECTRUM
+#include "ARMCM0.h"
+#include "app/uart.h"
+#endif
+
 struct FrequencyBandInfo
 {
     uint32_t lower;
@@ -71,6 +76,25 @@ static uint16_t blacklistFreqs[15];
 static uint8_t blacklistFreqsIdx;
 #endif
 
+#ifdef ENABLE_SPECTRUM_DWELL
+#define DWELL_MAX 4         // readings at a bin close to the trigger level
+#define DWELL_NEAR 12       // 6 dB either side of it
+#define DWELL_SAMPLE_US 200
+#endif
+
+#ifdef ENABLE_SPECTRUM_REFINE
+// coarse bins wider than this fall outside the 25 kHz filter
+#define REFINE_BIN_WIDTH 2500
+// 5 dB over the quietest coarse bin of the previous sweep
+#define REFINE_MARGIN 10
+
+static uint16_t refineStride;    // steps per coarse bin, 1 = plain sweep
+static uint16_t refineLeft;      // steps of the current bin still to measure
+static uint16_t refineFloor;     // quietest coarse bin of the previous sweep
+static uint16_t refineFloorNext; // and of this one
+static bool refineWide;          // REG_43 holds the coarse bandwidth
+#endif
+
 const char *bwOptions[] = {"25", "12.5", "6.25"};
 const uint8_t modulationTypeTuneSteps[] = {100, 50, 10};
 const uint8_t modTypeReg47Values[] = {1, 7, 5};
@@ -90,6 +114,13 @@ SpectrumSettings settings = {.stepsCount = STEPS_64,
 uint32_t fMeasure = 0;
 uint32_t currentFreq, tempFreq;
 uint16_t rssiHistory[128];
+#ifdef ENABLE_SPECTRUM_DWELL
+// readings to average at each rssiHistory column on the next sweep, 0 = 1
+static uint8_t rssiDwell[128];
+// columns read this sweep, and those that came near the trigger level
+static uint8_t dwellSeen[128 / 8];
+static uint8_t dwellNear[128 / 8];
+#endif
 int vfo;
 uint8_t freqInputIndex = 0;
 uint8_t freqInputDotIndex = 0;
@@ -348,7 +379,7 @@ static void ToggleAFDAC(bool on)
     BK4819_WriteRegister(BK4819_REG_30, Reg);
 }
 
-static void SetF(uint32_t f)
+RAMFUNC static void SetF(uint32_t f)
 {
     fMeasure = f;
 
@@ -412,7 +443,7 @@ uint8_t GetBWRegValueForScan()
     return scanStepBWRegValues[settings.scanStepIndex];
 }
 
-uint16_t GetRssi()
+RAMFUNC uint16_t GetRssi()
 {
     // SYSTICK_DelayUs(800);
     // testing autodelay based on Glitch value
@@ -465,6 +496,10 @@ static void ToggleRX(bool on)
     {
         BK4819_WriteRegister(0x43, GetBWRegValueForScan());
     }
+
+#ifdef ENABLE_SPECTRUM_REFINE
+    refineWide = false;
+#endif
 }
 
 // Scan info
@@ -485,6 +520,14 @@ static void InitScan()
 
     scanInfo.scanStep = GetScanStep();
     scanInfo.measurementsCount = GetStepsCount();
+
+#ifdef ENABLE_SPECTRUM_REFINE
+    refineStride = scanInfo.scanStep < REFINE_BIN_WIDTH ? REFINE_BIN_WIDTH / scanInfo.scanStep : 1;
+    refineLeft = 0;
+    if (refineFloorNext != RSSI_MAX_VALUE)
+        refineFloor = refineFloorNext;
+    refineFloorNext = RSSI_MAX_VALUE;
+#endif
 }
 
 static void ResetBlacklist()
@@ -510,6 +553,15 @@ static void RelaunchScan()
 #endif
     preventKeypress = true;
     scanInfo.rssiMin = RSSI_MAX_VALUE;
+#ifdef ENABLE_SPECTRUM_DWELL
+    memset(rssiDwell, 0, sizeof(rssiDwell));
+    memset(dwellSeen, 0, sizeof(dwellSeen));
+    memset(dwellNear, 0, sizeof(dwellNear));
+#endif
+#ifdef ENABLE_SPECTRUM_REFINE
+    // nothing to compare against yet, the first sweep measures every step
+    refineFloor = 0;
+#endif
 }
 
 static void UpdateScanInfo()
@@ -552,12 +604,21 @@ static void UpdatePeakInfo()
         UpdatePeakInfoForce();
 }
 
+static uint8_t GetHistoryIndex(uint16_t idx)
+{
+#ifdef ENABLE_SCAN_RANGES
+    if (scanInfo.measurementsCount > 128)
+        return (uint32_t)ARRAY_SIZE(rssiHistory) * 1000 / scanInfo.measurementsCount * idx / 1000;
+#endif
+    return idx;
+}
+
 static void SetRssiHistory(uint16_t idx, uint16_t rssi)
 {
 #ifdef ENABLE_SCAN_RANGES
     if (scanInfo.measurementsCount > 128)
     {
-        uint8_t i = (uint32_t)ARRAY_SIZE(rssiHistory) * 1000 / scanInfo.measurementsCount * idx / 1000;
+        uint8_t i = GetHistoryIndex(idx);
         if (rssiHistory[i] < rssi || isListening)
             rssiHistory[i] = rssi;
         rssiHistory[(i + 1) % 128] = 0;
@@ -567,12 +628,60 @@ static void SetRssiHistory(uint16_t idx, uint16_t rssi)
     rssiHistory[idx] = rssi;
 }
 
-static void Measure()
+RAMFUNC static void Measure()
 {
     uint16_t rssi = scanInfo.rssi = GetRssi();
     SetRssiHistory(scanInfo.i, rssi);
 }
 
+#ifdef ENABLE_SPECTRUM_DWELL
+// Sweep reading. A column that came within DWELL_NEAR of the trigger
+// level is averaged over DWELL_MAX readings on the following sweeps, then
+// falls back one reading per sweep once it stays clear of it. Everything
+// else gets a single reading, so a lone spike near the trigger level has
+// to survive the average before it makes a peak. With more than 128 steps
+// several share a column, so the counts only move in DwellSweepDone().
+RAMFUNC static void MeasureDwell()
+{
+    const uint8_t bin = MIN(GetHistoryIndex(scanInfo.i), ARRAY_SIZE(rssiDwell) - 1);
+    uint32_t sum = GetRssi();
+    uint8_t n;
+
+    for (n = 1; n < rssiDwell[bin]; n++)
+    {
+        SYSTICK_DelayUs(DWELL_SAMPLE_US);
+        sum += GetRssi();
+    }
+
+    const uint16_t rssi = scanInfo.rssi = sum / n;
+    SetRssiHistory(scanInfo.i, rssi);
+
+    dwellSeen[bin >> 3] |= 1u << (bin & 7);
+    if (rssi + DWELL_NEAR >= settings.rssiTriggerLevel && rssi <= settings.rssiTriggerLevel + DWELL_NEAR)
+        dwellNear[bin >> 3] |= 1u << (bin & 7);
+}
+
+// Once per sweep: columns that were read move their count, the rest keep it
+static void DwellSweepDone()
+{
+    for (uint8_t bin = 0; bin < ARRAY_SIZE(rssiDwell); bin++)
+    {
+        const uint8_t mask = 1u << (bin & 7);
+
+        if (!(dwellSeen[bin >> 3] & mask))
+            continue;
+
+        if (dwellNear[bin >> 3] & mask)
+            rssiDwell[bin] = DWELL_MAX;
+        else if (rssiDwell[bin] > 1)
+            rssiDwell[bin]--;
+    }
+
+    memset(dwellSeen, 0, sizeof(dwellSeen));
+    memset(dwellNear, 0, sizeof(dwellNear));
+}
+#endif
+
 // Update things by keypress
 
 static uint16_t dbm2rssi(int dBm)
@@ -954,12 +1063,23 @@ static void DrawStatus()
 #ifdef ENABLE_FEAT_F4HWN_SPECTRUM
 static void ShowChannelName(uint32_t f)
 {
+#ifndef ENABLE_CHANNEL_INDEX
     unsigned int i;
+#endif
     char String[12];
     memset(String, 0, sizeof(String));
 
     if (isListening)
     {
+#ifdef ENABLE_CHANNEL_INDEX
+        const int channel = SETTINGS_FindChannelByFrequency(f);
+        if (channel >= 0)
+        {
+            SETTINGS_FetchChannelNameCached(String, channel);
+            if (String[0] != 0)
+                UI_PrintStringSmallBufferNormal(String, gStatusLine + 36);
+        }
+#else
         for (i = 0; IS_MR_CHANNEL(i); i++)
         {
             if (RADIO_CheckValidChannel(i, false, 0))
@@ -975,6 +1095,7 @@ static void ShowChannelName(uint32_t f)
                 }
             }
         }
+#endif
     }
     else
     {
@@ -1477,7 +1598,7 @@ bool HandleUserInput()
     return true;
 }
 
-static void Scan()
+RAMFUNC static void Scan()
 {
     if (rssiHistory[scanInfo.i] != RSSI_MAX_VALUE
 #ifdef ENABLE_SCAN_RANGES
@@ -1486,7 +1607,11 @@ static void Scan()
     )
     {
         SetF(scanInfo.f);
+#ifdef ENABLE_SPECTRUM_DWELL
+        MeasureDwell();
+#else
         Measure();
+#endif
         UpdateScanInfo();
     }
 }
@@ -1498,20 +1623,94 @@ static void NextScanStep()
     scanInfo.f += scanInfo.scanStep;
 }
 
-static void UpdateScan()
+#ifdef ENABLE_SPECTRUM_REFINE
+static void SetScanBW(bool wide)
 {
-    Scan();
+    if (wide != refineWide)
+    {
+        refineWide = wide;
+        BK4819_WriteRegister(0x43, wide ? listenBWRegValues[BK4819_FILTER_BW_WIDE] : GetBWRegValueForScan());
+    }
+}
 
-    if (scanInfo.i < scanInfo.measurementsCount)
+// One reading per call. Each bin of refineStride steps is first read once
+// at 25 kHz from its centre, and its steps are only measured one by one
+// when that reading stands out of the noise. The others are drawn at the
+// floor of the previous sweep. Returns false once the sweep is done.
+RAMFUNC static bool ScanRefined()
+{
+    if (refineLeft)
     {
+        SetScanBW(false);
+        Scan();
+        NextScanStep();
+        refineLeft--;
+        return true;
+    }
+
+    if (scanInfo.i >= scanInfo.measurementsCount)
+        return false;
+
+    const uint16_t steps = MIN(refineStride, scanInfo.measurementsCount - scanInfo.i);
+
+    SetScanBW(true);
+    SetF(scanInfo.f + (steps / 2) * scanInfo.scanStep);
+    const uint16_t rssi = GetRssi();
+
+    if (rssi < refineFloorNext)
+        refineFloorNext = rssi;
+
+    if (rssi >= refineFloor + REFINE_MARGIN)
+    {
+        refineLeft = steps;
+        return true;
+    }
+
+    const uint16_t fill = scanInfo.rssiMin != RSSI_MAX_VALUE ? scanInfo.rssiMin : rssi;
+    for (uint16_t k = 0; k < steps; k++)
+    {
+        if (scanInfo.measurementsCount > 128 || rssiHistory[scanInfo.i] != RSSI_MAX_VALUE)
+            SetRssiHistory(scanInfo.i, fill);
         NextScanStep();
-        return;
     }
 
+    return true;
+}
+#endif
+
+static void UpdateScan()
+{
+#ifdef ENABLE_SPECTRUM_REFINE
+    if (refineStride > 1)
+    {
+        if (ScanRefined())
+            return;
+        SetScanBW(false);
+    }
+    else
+#endif
+    {
+        Scan();
+
+        if (scanInfo.i < scanInfo.measurementsCount)
+        {
+            NextScanStep();
+            return;
+        }
+    }
+
+#ifdef ENABLE_SPECTRUM_DWELL
+    DwellSweepDone();
+#endif
+
     if (scanInfo.measurementsCount < 128)
         memset(&rssiHistory[scanInfo.measurementsCount], 0,
                sizeof(rssiHistory) - scanInfo.measurementsCount * sizeof(rssiHistory[0]));
 
+#ifdef ENABLE_UART_SPECTRUM
+    UART_SpectrumSweep(GetFStart(), GetScanStep(), scanInfo.measurementsCount, rssiHistory);
+#endif
+
     redrawScreen = true;
     preventKeypress = false;
 
@@ -1612,6 +1811,16 @@ static void Tick()
     }
 #endif
 
+#ifdef ENABLE_UART_SPECTRUM
+    if (UART_IsCommandAvailable())
+    {
+        __disable_irq();
+        UART_HandleCommand();
+        __enable_irq();
+    }
+    UART_SpectrumPump();
+#endif
+
     if (!preventKeypress)
     {
         HandleUserInput();
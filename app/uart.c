@@ -22,7 +22,13 @@
 #ifdef ENABLE_FMRADIO
     #include "app/fm.h"
 #endif
+#ifdef ENABLE_PROFILER
+    #include "app/profiler.h"
+#endif
 #include "app/uart.h"
+#ifdef ENABLE_UART_TELEMETRY
+    #include "am_fix.h"
+#endif
 #include "board.h"
 #include "bsp/dp32g030/dma.h"
 #include "bsp/dp32g030/gpio.h"
@@ -32,9 +38,14 @@
 #include "driver/crc.h"
 #include "driver/eeprom.h"
 #include "driver/gpio.h"
+#include "driver/systick.h"
 #include "driver/uart.h"
 #include "functions.h"
 #include "misc.h"
+#ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
+    #include "screenshot.h"
+#endif
+#include "radio.h"
 #include "settings.h"
 #include "version.h"
 
@@ -106,6 +117,40 @@ typedef struct {
     } Data;
 } REPLY_051D_t;
 
+#ifdef ENABLE_UART_BULK
+// bulk read, answered by a stream of 0x0531 windows:
+// Offset, Size, Data[Size] and the CRC of Data
+typedef struct {
+    Header_t Header;
+    uint16_t Offset;
+    uint16_t Size;
+    uint16_t Window;
+    uint16_t Padding;
+    uint32_t Timestamp;
+} CMD_0530_t;
+
+// bulk write verify, a chunk of writes is checked against its CRC
+typedef struct {
+    Header_t Header;
+    uint16_t Offset;
+    uint16_t Size;
+    uint16_t Crc;
+    uint16_t Padding;
+    uint32_t Timestamp;
+} CMD_0534_t;
+
+typedef struct {
+    Header_t Header;
+    struct {
+        uint16_t Offset;
+        uint16_t Size;
+        uint16_t Crc;
+        bool     bOk;
+        uint8_t  Padding;
+    } Data;
+} REPLY_0535_t;
+#endif
+
 typedef struct {
     Header_t Header;
     struct {
@@ -141,6 +186,99 @@ typedef struct {
     uint32_t Timestamp;
 } CMD_052F_t;
 
+#ifdef ENABLE_UART_TELEMETRY
+typedef struct {
+    Header_t Header;
+    uint8_t  Decimation;    // one frame every that many 10 ms ticks, 0 stops
+    uint8_t  Padding[3];
+} CMD_0605_t;
+
+typedef struct {
+    Header_t Header;
+    struct {
+        uint16_t Sequence;  // counts dropped frames too
+        uint16_t RSSI;
+        uint32_t Frequency;
+        uint8_t  ExNoiseIndicator;
+        uint8_t  GlitchIndicator;
+        uint8_t  AfAmplitude;
+        uint8_t  AmFixGainIndex;
+        uint8_t  Function;
+        uint8_t  Padding[3];
+    } Data;
+} REPLY_0606_t;
+#endif
+
+#ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
+typedef struct {
+    Header_t Header;
+    uint8_t  Enable;        // mirror the screen as it changes, see screenshot.h
+    uint8_t  Padding[3];
+} CMD_0609_t;
+#endif
+
+#ifdef ENABLE_TICKLESS_IDLE
+typedef struct {
+    Header_t Header;
+    struct {
+        uint8_t  IdlePercent;   // of the last 500 ms slice
+        uint8_t  Padding[3];
+        uint32_t Ticks;         // 10 ms ticks since boot
+        uint32_t SkippedTicks;  // of those, the ones slept through
+    } Data;
+} REPLY_060B_t;
+#endif
+
+#ifdef ENABLE_PROFILER
+typedef struct {
+    Header_t Header;
+    uint8_t  Reset;         // clear the statistics once they are sent
+    uint8_t  Padding[3];
+} CMD_060C_t;
+
+typedef struct {
+    Header_t Header;
+    struct {
+        uint32_t ElapsedUs;     // since the statistics were last cleared
+        uint32_t MissedSlices;
+        uint8_t  LoadPercent;
+        uint8_t  Padding[3];
+        struct {
+            uint32_t Count;
+            uint32_t MinUs;
+            uint32_t MeanUs;
+            uint32_t MaxUs;
+        } Stats[PROFILER_N_ELEM]; // in PROFILER_Id_t order
+    } Data;
+} REPLY_060D_t;
+#endif
+
+#ifdef ENABLE_UART_SPECTRUM
+typedef struct {
+    Header_t Header;
+    uint8_t  Enable;
+    uint8_t  Padding[3];
+} CMD_0607_t;
+
+typedef struct {
+    Header_t Header;
+    struct {
+        uint16_t Sequence;  // counts sweeps that were never sent too
+        uint16_t Count;     // steps in the sweep, Rssi[] holds min(Count, 128)
+        uint32_t FStart;
+        uint16_t Step;
+        uint16_t Padding;
+        uint16_t Rssi[128];
+    } Data;
+} REPLY_0608_t;
+
+typedef struct {
+    Header_t     Header;
+    REPLY_0608_t Reply;
+    Footer_t     Footer;
+} SpectrumFrame_t;
+#endif
+
 static const uint8_t Obfuscation[16] =
 {
     0x16, 0x6C, 0x14, 0xE6, 0x2E, 0x91, 0x0D, 0x40, 0x21, 0x35, 0xD5, 0x40, 0x13, 0x03, 0xE9, 0x80
@@ -160,36 +298,103 @@ static uint32_t Timestamp;
 static uint16_t gUART_WriteIndex;
 static bool     bIsEncrypted = true;
 
-static void SendReply(void *pReply, uint16_t Size)
-{
-    Header_t Header;
-    Footer_t Footer;
+#ifdef ENABLE_UART_TELEMETRY
+    static uint8_t  gTelemetryDecimation;
+    static uint8_t  gTelemetryCountdown;
+    static uint16_t gTelemetrySequence;
+#endif
+
+#ifdef ENABLE_UART_SPECTRUM
+    // one frame is being sent while the other takes the newest sweep
+    static SpectrumFrame_t gSpectrumFrames[2];
+    static bool            gSpectrumEnabled;
+    static uint16_t        gSpectrumSequence;
+    static int8_t          gSpectrumSending = -1;
+    static int8_t          gSpectrumPending = -1;
+    static uint16_t        gSpectrumOffset;
+#endif
+
+#ifdef ENABLE_UART_BULK
+    #define BULK_WINDOW_MAX 4096
+    #define BULK_PIECE_SIZE 64
 
+    enum {
+        BULK_IDLE = 0,
+        BULK_HEAD,
+        BULK_DATA,
+        BULK_TAIL
+    };
+
+    // bulk read in progress, fed into the TX queue a piece at a time
+    static struct {
+        uint8_t  State;
+        uint8_t  PieceSize;
+        uint8_t  PieceSent;
+        uint16_t Offset;
+        uint16_t End;
+        uint16_t Window;
+        uint16_t WindowEnd;
+        uint16_t Position;  // bytes of the current reply obfuscated so far
+        uint16_t Crc;
+        uint8_t  Piece[BULK_PIECE_SIZE];
+    } gBulkRead;
+
+    // bulk write verify in progress, CRCed a piece per UART_BulkPump()
+    static struct {
+        bool     bBusy;
+        uint16_t Offset;
+        uint16_t Size;
+        uint16_t Done;
+        uint16_t Crc;
+        uint16_t Expected;
+    } gBulkVerify;
+#endif
+
+// Position is where pBytes starts within the reply
+static void ObfuscateAt(void *pBytes, uint16_t Size, uint16_t Position)
+{
     if (bIsEncrypted)
     {
-        uint8_t     *pBytes = (uint8_t *)pReply;
+        uint8_t     *pData = (uint8_t *)pBytes;
         unsigned int i;
         for (i = 0; i < Size; i++)
-            pBytes[i] ^= Obfuscation[i % 16];
+            pData[i] ^= Obfuscation[(Position + i) % 16];
     }
+}
 
-    Header.ID = 0xCDAB;
-    Header.Size = Size;
-    UART_Send(&Header, sizeof(Header));
-    UART_Send(pReply, Size);
-
+// the footer of a reply Size bytes long
+static void MakeFooter(Footer_t *pFooter, uint16_t Size)
+{
     if (bIsEncrypted)
     {
-        Footer.Padding[0] = Obfuscation[(Size + 0) % 16] ^ 0xFF;
-        Footer.Padding[1] = Obfuscation[(Size + 1) % 16] ^ 0xFF;
+        pFooter->Padding[0] = Obfuscation[(Size + 0) % 16] ^ 0xFF;
+        pFooter->Padding[1] = Obfuscation[(Size + 1) % 16] ^ 0xFF;
     }
     else
     {
-        Footer.Padding[0] = 0xFF;
-        Footer.Padding[1] = 0xFF;
+        pFooter->Padding[0] = 0xFF;
+        pFooter->Padding[1] = 0xFF;
     }
-    Footer.ID = 0xBADC;
+    pFooter->ID = 0xBADC;
+}
 
+static void Obfuscate(void *pReply, uint16_t Size, Footer_t *pFooter)
+{
+    ObfuscateAt(pReply, Size, 0);
+    MakeFooter(pFooter, Size);
+}
+
+static void SendReply(void *pReply, uint16_t Size)
+{
+    Header_t Header;
+    Footer_t Footer;
+
+    Obfuscate(pReply, Size, &Footer);
+
+    Header.ID = 0xCDAB;
+    Header.Size = Size;
+    UART_Send(&Header, sizeof(Header));
+    UART_Send(pReply, Size);
     UART_Send(&Footer, sizeof(Footer));
 }
 
@@ -282,8 +487,8 @@ static void CMD_051B(const uint8_t *pBuffer)
     SendReply(&Reply, pCmd->Size + 8);
 }
 
-// write eeprom
-static void CMD_051D(const uint8_t *pBuffer)
+// write eeprom, ReplyID tells the legacy and the bulk write apart
+static void WriteEeprom(const uint8_t *pBuffer, uint16_t ReplyID)
 {
     const CMD_051D_t *pCmd = (const CMD_051D_t *)pBuffer;
     REPLY_051D_t Reply;
@@ -301,7 +506,7 @@ static void CMD_051D(const uint8_t *pBuffer)
         gFmRadioCountdown_500ms = fm_radio_countdown_500ms;
     #endif
 
-    Reply.Header.ID   = 0x051E;
+    Reply.Header.ID   = ReplyID;
     Reply.Header.Size = sizeof(Reply.Data);
     Reply.Data.Offset = pCmd->Offset;
 
@@ -310,6 +515,7 @@ static void CMD_051D(const uint8_t *pBuffer)
     if (!bIsLocked)
     {
         unsigned int i;
+        unsigned int Run = 0;   // blocks allowed through but not written yet
         for (i = 0; i < (pCmd->Size / 8); i++)
         {
             const uint16_t Offset = pCmd->Offset + (i * 8U);
@@ -318,9 +524,42 @@ static void CMD_051D(const uint8_t *pBuffer)
                 if (!gIsLocked)
                     bReloadEeprom = true;
 
-            if ((Offset < 0x0E98 || Offset >= 0x0EA0) || !bIsInLockScreen || pCmd->bAllowPassword)
-                EEPROM_WriteBuffer(Offset, &pCmd->Data[i * 8U]);
+            if ((Offset < 0x0E98 || Offset >= 0x0EA0) || !bIsInLockScreen || pCmd->bAllowPassword) {
+                Run++;
+            }
+            else {
+                EEPROM_WritePage(Offset - Run * 8U, &pCmd->Data[(i - Run) * 8U], Run * 8U);
+                Run = 0;
+            }
         }
+        EEPROM_WritePage(pCmd->Offset + (i - Run) * 8U, &pCmd->Data[(i - Run) * 8U], Run * 8U);
+
+#if defined(ENABLE_CHANNEL_INDEX) || defined(ENABLE_CHANNEL_CACHE) || defined(ENABLE_SCAN_PREFETCH)
+        {   // drop what the RAM caches hold of the range just written
+            const uint32_t End       = pCmd->Offset + pCmd->Size;
+            const bool     bChannels = pCmd->Offset < 0x0C80 ||                    // channel records
+                                       (pCmd->Offset < 0x1BD0 && End > 0x0F50);    // channel names
+
+            if (bChannels) {
+#ifdef ENABLE_CHANNEL_INDEX
+                // rebuilt on the next lookup, not here with interrupts off
+                SETTINGS_InvalidateChannelIndex();
+#endif
+#ifdef ENABLE_CHANNEL_CACHE
+                SETTINGS_ClearChannelCache();
+#endif
+#ifdef ENABLE_SCAN_PREFETCH
+                // the next scan hop must not use a channel loaded before this
+                RADIO_DropPrefetch();
+#endif
+            }
+
+#ifdef ENABLE_CHANNEL_CACHE
+            if (End > 0x1E00)                                                      // calibration
+                RADIO_ClearCalibrationCache();
+#endif
+        }
+#endif
 
         if (bReloadEeprom)
             SETTINGS_InitEEPROM();
@@ -329,6 +568,217 @@ static void CMD_051D(const uint8_t *pBuffer)
     SendReply(&Reply, sizeof(Reply));
 }
 
+static void CMD_051D(const uint8_t *pBuffer)
+{
+    WriteEeprom(pBuffer, 0x051E);
+}
+
+#ifdef ENABLE_UART_BULK
+// same layout as 0x051D, but Size can reach past what the frame carried
+static void CMD_0532(const uint8_t *pBuffer)
+{
+    const CMD_051D_t *pCmd = (const CMD_051D_t *)pBuffer;
+
+    if (pCmd->Header.Size < 8 || pCmd->Size > pCmd->Header.Size - 8 || (pCmd->Size % 8) != 0 ||
+        pCmd->Size > sizeof(UART_Command.Buffer) - sizeof(CMD_051D_t) - 2)
+        return;
+
+    WriteEeprom(pBuffer, 0x0533);
+}
+#endif
+
+#ifdef ENABLE_UART_BULK
+// start a bulk read, UART_BulkPump() sends it
+static void CMD_0530(const uint8_t *pBuffer)
+{
+    const CMD_0530_t *pCmd = (const CMD_0530_t *)pBuffer;
+    uint32_t          End  = (uint32_t)pCmd->Offset + pCmd->Size;
+
+    // one stream at a time, its frames must not be cut by another
+    if (pCmd->Timestamp != Timestamp || gBulkRead.State != BULK_IDLE)
+        return;
+
+    if (End > 0x2000)
+        End = 0x2000;
+
+    if (pCmd->Size == 0 || pCmd->Offset >= End)
+        return;
+
+    gSerialConfigCountDown_500ms = 12; // 6 sec
+
+    gBulkRead.Offset    = pCmd->Offset;
+    gBulkRead.End       = End;
+    gBulkRead.Window    = (pCmd->Window == 0 || pCmd->Window > BULK_WINDOW_MAX) ? BULK_WINDOW_MAX : pCmd->Window;
+    gBulkRead.PieceSize = 0;
+    gBulkRead.PieceSent = 0;
+    gBulkRead.State     = BULK_HEAD;
+}
+
+// check what the bulk writes left in the EEPROM: UART_BulkPump() reads it
+// back a piece a tick, with interrupts on, and answers
+static void CMD_0534(const uint8_t *pBuffer)
+{
+    const CMD_0534_t *pCmd = (const CMD_0534_t *)pBuffer;
+
+    if (pCmd->Timestamp != Timestamp)
+        return;
+
+    gSerialConfigCountDown_500ms = 12; // 6 sec
+
+    // one at a time, the client waits for the answer before the next
+    if (gBulkVerify.bBusy)
+        return;
+
+    gBulkVerify.Offset   = pCmd->Offset;
+    gBulkVerify.Size     = pCmd->Size;
+    gBulkVerify.Done     = 0;
+    gBulkVerify.Crc      = 0;
+    gBulkVerify.Expected = pCmd->Crc;
+    gBulkVerify.bBusy    = true;
+}
+
+// a piece of the read-back per call, the answer once it is all read
+static void BulkVerifyNextPiece(void)
+{
+    if (gBulkVerify.Done < gBulkVerify.Size && gBulkVerify.Offset + gBulkVerify.Done < 0x2000)
+    {
+        uint8_t  Data[BULK_PIECE_SIZE];
+        uint16_t Size = gBulkVerify.Size - gBulkVerify.Done;
+
+        if (Size > sizeof(Data))
+            Size = sizeof(Data);
+
+        EEPROM_ReadBuffer(gBulkVerify.Offset + gBulkVerify.Done, Data, Size);
+        gBulkVerify.Crc   = CRC_Update(gBulkVerify.Crc, Data, Size);
+        gBulkVerify.Done += Size;
+        return;
+    }
+
+    REPLY_0535_t Reply;
+
+    Reply.Header.ID    = 0x0535;
+    Reply.Header.Size  = sizeof(Reply.Data);
+    Reply.Data.Offset  = gBulkVerify.Offset;
+    Reply.Data.Size    = gBulkVerify.Done;
+    Reply.Data.Crc     = gBulkVerify.Crc;
+    Reply.Data.bOk     = gBulkVerify.Done == gBulkVerify.Size && gBulkVerify.Crc == gBulkVerify.Expected;
+    Reply.Data.Padding = 0;
+
+    SendReply(&Reply, sizeof(Reply));
+    gBulkVerify.bBusy = false;
+}
+
+// the next piece of the bulk read: reply header, data or CRC and footer
+static void BulkNextPiece(void)
+{
+    uint8_t *pPiece = gBulkRead.Piece;
+
+    switch (gBulkRead.State)
+    {
+        case BULK_HEAD:
+        {
+            const uint16_t Size = (gBulkRead.End - gBulkRead.Offset < gBulkRead.Window) ?
+                                  gBulkRead.End - gBulkRead.Offset : gBulkRead.Window;
+            struct {
+                Header_t Header;
+                Header_t Reply;
+                uint16_t Offset;
+                uint16_t Size;
+            } Head;
+
+            Head.Header.ID   = 0xCDAB;
+            Head.Header.Size = sizeof(Head.Reply) + 4 + Size + 2;
+            Head.Reply.ID    = 0x0531;
+            Head.Reply.Size  = 4 + Size + 2;
+            Head.Offset      = gBulkRead.Offset;
+            Head.Size        = Size;
+
+            ObfuscateAt(&Head.Reply, sizeof(Head) - sizeof(Head.Header), 0);
+            memcpy(pPiece, &Head, sizeof(Head));
+
+            gBulkRead.PieceSize = sizeof(Head);
+            gBulkRead.WindowEnd = gBulkRead.Offset + Size;
+            gBulkRead.Position  = sizeof(Head) - sizeof(Head.Header);
+            gBulkRead.Crc       = 0;
+            gBulkRead.State     = BULK_DATA;
+
+            gSerialConfigCountDown_500ms = 12; // 6 sec
+            break;
+        }
+
+        case BULK_DATA:
+        {
+            const bool bLocked = bHasCustomAesKey && gIsLocked;
+            uint16_t   Size    = gBulkRead.WindowEnd - gBulkRead.Offset;
+
+            if (Size > BULK_PIECE_SIZE)
+                Size = BULK_PIECE_SIZE;
+
+            if (bLocked)
+                memset(pPiece, 0, Size);
+            else
+                EEPROM_ReadBuffer(gBulkRead.Offset, pPiece, Size);
+
+            gBulkRead.Crc = CRC_Update(gBulkRead.Crc, pPiece, Size);
+            ObfuscateAt(pPiece, Size, gBulkRead.Position);
+
+            gBulkRead.PieceSize  = Size;
+            gBulkRead.Offset    += Size;
+            gBulkRead.Position  += Size;
+
+            if (gBulkRead.Offset == gBulkRead.WindowEnd)
+                gBulkRead.State = BULK_TAIL;
+            break;
+        }
+
+        case BULK_TAIL:
+        {
+            Footer_t Footer;
+
+            memcpy(pPiece, &gBulkRead.Crc, 2);
+            ObfuscateAt(pPiece, 2, gBulkRead.Position);
+            MakeFooter(&Footer, gBulkRead.Position + 2);
+            memcpy(pPiece + 2, &Footer, sizeof(Footer));
+
+            gBulkRead.PieceSize = 2 + sizeof(Footer);
+            gBulkRead.State     = (gBulkRead.Offset == gBulkRead.End) ? BULK_IDLE : BULK_HEAD;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    gBulkRead.PieceSent = 0;
+}
+
+void UART_BulkPump(void)
+{
+    // the answer must not land inside a 0x0531 reply
+    if (gBulkVerify.bBusy && gBulkRead.State == BULK_IDLE && gBulkRead.PieceSize == 0)
+        BulkVerifyNextPiece();
+
+    while (1)
+    {
+        if (gBulkRead.PieceSent < gBulkRead.PieceSize)
+        {
+            gBulkRead.PieceSent += UART_SendSome(gBulkRead.Piece + gBulkRead.PieceSent,
+                                                 gBulkRead.PieceSize - gBulkRead.PieceSent);
+            if (gBulkRead.PieceSent < gBulkRead.PieceSize)
+                return;
+        }
+
+        if (gBulkRead.State == BULK_IDLE)
+        {
+            gBulkRead.PieceSize = 0;
+            return;
+        }
+
+        BulkNextPiece();
+    }
+}
+#endif
+
 // read RSSI
 static void CMD_0527(void)
 {
@@ -439,6 +889,166 @@ static void CMD_052F(const uint8_t *pBuffer)
     SendVersion();
 }
 
+#ifdef ENABLE_UART_TELEMETRY
+// subscribe to the telemetry stream, UART_SendTelemetry() does the rest
+static void CMD_0605(const uint8_t *pBuffer)
+{
+    const CMD_0605_t *pCmd = (const CMD_0605_t *)pBuffer;
+
+    gTelemetryDecimation = pCmd->Decimation;
+    gTelemetryCountdown  = 0;
+}
+
+void UART_SendTelemetry(void)
+{
+    struct {
+        Header_t     Header;
+        REPLY_0606_t Reply;
+        Footer_t     Footer;
+    } Frame;
+
+    if (gTelemetryDecimation == 0 || gTelemetryCountdown-- > 0)
+        return;
+
+    gTelemetryCountdown = gTelemetryDecimation - 1;
+
+    Frame.Header.ID                   = 0xCDAB;
+    Frame.Header.Size                 = sizeof(Frame.Reply);
+    Frame.Reply.Header.ID             = 0x0606;
+    Frame.Reply.Header.Size           = sizeof(Frame.Reply.Data);
+    Frame.Reply.Data.Sequence         = gTelemetrySequence++;
+    Frame.Reply.Data.RSSI             = BK4819_ReadRegister(BK4819_REG_67) & 0x01FF;
+    Frame.Reply.Data.Frequency        = gRxVfo->pRX->Frequency;
+    Frame.Reply.Data.ExNoiseIndicator = BK4819_ReadRegister(BK4819_REG_65) & 0x007F;
+    Frame.Reply.Data.GlitchIndicator  = BK4819_ReadRegister(BK4819_REG_63);
+    Frame.Reply.Data.AfAmplitude      = BK4819_GetAfTxRx();
+    #ifdef ENABLE_AM_FIX
+        Frame.Reply.Data.AmFixGainIndex = AM_fix_get_gain_index(gEeprom.RX_VFO);
+    #else
+        Frame.Reply.Data.AmFixGainIndex = 0;
+    #endif
+    Frame.Reply.Data.Function         = gCurrentFunction;
+    memset(Frame.Reply.Data.Padding, 0, sizeof(Frame.Reply.Data.Padding));
+
+    Obfuscate(&Frame.Reply, sizeof(Frame.Reply), &Frame.Footer);
+
+    // a full queue drops the frame, the host sees the gap in Sequence
+    UART_SendAsync(&Frame, sizeof(Frame));
+}
+#endif
+
+#ifdef ENABLE_UART_SPECTRUM
+static void CMD_0607(const uint8_t *pBuffer)
+{
+    const CMD_0607_t *pCmd = (const CMD_0607_t *)pBuffer;
+
+    gSpectrumEnabled = pCmd->Enable != 0;
+    if (!gSpectrumEnabled)
+        gSpectrumPending = -1;
+}
+
+void UART_SpectrumSweep(uint32_t FStart, uint16_t Step, uint16_t Count, const uint16_t *pRssi)
+{
+    SpectrumFrame_t *pFrame;
+    int8_t           Index;
+
+    if (!gSpectrumEnabled)
+        return;
+
+    Index  = (gSpectrumSending == 0) ? 1 : 0;
+    pFrame = &gSpectrumFrames[Index];
+
+    pFrame->Header.ID              = 0xCDAB;
+    pFrame->Header.Size            = sizeof(pFrame->Reply);
+    pFrame->Reply.Header.ID        = 0x0608;
+    pFrame->Reply.Header.Size      = sizeof(pFrame->Reply.Data);
+    pFrame->Reply.Data.Sequence    = gSpectrumSequence++;
+    pFrame->Reply.Data.Count       = Count;
+    pFrame->Reply.Data.FStart      = FStart;
+    pFrame->Reply.Data.Step        = Step;
+    pFrame->Reply.Data.Padding     = 0;
+    memcpy(pFrame->Reply.Data.Rssi, pRssi, sizeof(pFrame->Reply.Data.Rssi));
+
+    Obfuscate(&pFrame->Reply, sizeof(pFrame->Reply), &pFrame->Footer);
+
+    // replaces a sweep still waiting for its turn
+    gSpectrumPending = Index;
+}
+
+void UART_SpectrumPump(void)
+{
+    if (gSpectrumSending < 0)
+    {
+        if (gSpectrumPending < 0)
+            return;
+
+        gSpectrumSending = gSpectrumPending;
+        gSpectrumPending = -1;
+        gSpectrumOffset  = 0;
+    }
+
+    gSpectrumOffset += UART_SendSome((const uint8_t *)&gSpectrumFrames[gSpectrumSending] + gSpectrumOffset,
+                                     sizeof(SpectrumFrame_t) - gSpectrumOffset);
+
+    if (gSpectrumOffset == sizeof(SpectrumFrame_t))
+        gSpectrumSending = -1;
+}
+#endif
+
+#ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
+static void CMD_0609(const uint8_t *pBuffer)
+{
+    const CMD_0609_t *pCmd = (const CMD_0609_t *)pBuffer;
+
+    setScreenShotMirror(pCmd->Enable != 0);
+}
+#endif
+
+#ifdef ENABLE_TICKLESS_IDLE
+static void CMD_060A(void)
+{
+    REPLY_060B_t Reply;
+
+    Reply.Header.ID         = 0x060B;
+    Reply.Header.Size       = sizeof(Reply.Data);
+    Reply.Data.IdlePercent  = gIdlePercent;
+    Reply.Data.Ticks        = gGlobalSysTickCounter;
+    Reply.Data.SkippedTicks = gSysTickSkipped;
+    memset(Reply.Data.Padding, 0, sizeof(Reply.Data.Padding));
+
+    SendReply(&Reply, sizeof(Reply));
+}
+#endif
+
+#ifdef ENABLE_PROFILER
+static void CMD_060C(const uint8_t *pBuffer)
+{
+    const CMD_060C_t *pCmd = (const CMD_060C_t *)pBuffer;
+    REPLY_060D_t      Reply;
+
+    Reply.Header.ID         = 0x060D;
+    Reply.Header.Size       = sizeof(Reply.Data);
+    Reply.Data.ElapsedUs    = PROFILER_ElapsedUs();
+    Reply.Data.MissedSlices = gProfilerMissedSlices;
+    Reply.Data.LoadPercent  = PROFILER_LoadPercent();
+    memset(Reply.Data.Padding, 0, sizeof(Reply.Data.Padding));
+
+    for (unsigned int i = 0; i < PROFILER_N_ELEM; i++) {
+        const PROFILER_Stats_t *pStats = &gProfilerStats[i];
+
+        Reply.Data.Stats[i].Count  = pStats->Count;
+        Reply.Data.Stats[i].MinUs  = pStats->MinUs;
+        Reply.Data.Stats[i].MeanUs = pStats->Count ? pStats->TotalUs / pStats->Count : 0;
+        Reply.Data.Stats[i].MaxUs  = pStats->MaxUs;
+    }
+
+    SendReply(&Reply, sizeof(Reply));
+
+    if (pCmd->Reset)
+        PROFILER_Reset();
+}
+#endif
+
 #ifdef ENABLE_UART_RW_BK_REGS
 static void CMD_0601_ReadBK4819Reg(const uint8_t *pBuffer)
 {
@@ -460,7 +1070,8 @@ static void CMD_0601_ReadBK4819Reg(const uint8_t *pBuffer)
     reply.header.ID = 0x0601;
     reply.header.Size = sizeof(reply.data);
     reply.data.reg = cmd->reg;
-    reply.data.value = BK4819_ReadRegister(cmd->reg);
+    // what the chip holds, not what the shadow thinks it holds
+    reply.data.value = BK4819_ReadRegisterRaw(cmd->reg);
     SendReply(&reply, sizeof(reply));
 }
 
@@ -475,6 +1086,38 @@ static void CMD_0602_WriteBK4819Reg(const uint8_t *pBuffer)
     CMD_0602_t *cmd = (CMD_0602_t*) pBuffer;
     BK4819_WriteRegister(cmd->reg, cmd->value);
 }
+
+static void CMD_0603_BenchBK4819(const uint8_t *pBuffer)
+{
+    typedef struct __attribute__((__packed__)) {
+        Header_t header;
+        uint16_t count;
+    } CMD_0603_t;
+
+    CMD_0603_t *cmd = (CMD_0603_t*) pBuffer;
+    BK4819_Bench_t bench;
+
+    struct __attribute__((__packed__)) {
+        Header_t header;
+        struct __attribute__((__packed__)) {
+            uint16_t       count;
+            uint8_t        spin_per_us;
+            uint8_t        write_delays;
+            uint8_t        read_delays;
+            BK4819_Bench_t ticks;
+        } data;
+    } reply;
+
+    reply.header.ID = 0x0603;
+    reply.header.Size = sizeof(reply.data);
+    reply.data.count = cmd->count;
+    reply.data.spin_per_us = gSysTickSpinPerUs;
+    reply.data.write_delays = BK4819_WRITE_DELAYS;
+    reply.data.read_delays = BK4819_READ_DELAYS;
+    BK4819_Benchmark(&bench, cmd->count);
+    memcpy(&reply.data.ticks, &bench, sizeof(bench));
+    SendReply(&reply, sizeof(reply));
+}
 #endif
 
 bool UART_IsCommandAvailable(void)
@@ -514,7 +1157,7 @@ bool UART_IsCommandAvailable(void)
     Index = DMA_INDEX(gUART_WriteIndex, 2);
     Size  = (UART_DMA_Buffer[DMA_INDEX(Index, 1)] << 8) | UART_DMA_Buffer[Index];
 
-    if ((Size + 8u) > sizeof(UART_DMA_Buffer))
+    if ((Size + 8u) > sizeof(UART_DMA_Buffer) || (Size + 2u) > sizeof(UART_Command.Buffer))
     {
         gUART_WriteIndex = DmaLength;
         return false;
@@ -611,6 +1254,8 @@ void UART_HandleCommand(void)
             break;
     
         case 0x05DD: // reset
+            EEPROM_Flush();
+            UART_Flush();
             #if defined(ENABLE_OVERLAY)
                 overlay_FLASH_RebootToBootloader();
             #else
@@ -618,6 +1263,50 @@ void UART_HandleCommand(void)
             #endif
             break;
             
+#ifdef ENABLE_UART_BULK
+        case 0x0530:
+            CMD_0530(UART_Command.Buffer);
+            break;
+
+        case 0x0532:
+            CMD_0532(UART_Command.Buffer);
+            break;
+
+        case 0x0534:
+            CMD_0534(UART_Command.Buffer);
+            break;
+#endif
+
+#ifdef ENABLE_UART_TELEMETRY
+        case 0x0605:
+            CMD_0605(UART_Command.Buffer);
+            break;
+#endif
+
+#ifdef ENABLE_UART_SPECTRUM
+        case 0x0607:
+            CMD_0607(UART_Command.Buffer);
+            break;
+#endif
+
+#ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
+        case 0x0609:
+            CMD_0609(UART_Command.Buffer);
+            break;
+#endif
+
+#ifdef ENABLE_TICKLESS_IDLE
+        case 0x060A:
+            CMD_060A();
+            break;
+#endif
+
+#ifdef ENABLE_PROFILER
+        case 0x060C:
+            CMD_060C(UART_Command.Buffer);
+            break;
+#endif
+
 #ifdef ENABLE_UART_RW_BK_REGS
         case 0x0601:
             CMD_0601_ReadBK4819Reg(UART_Command.Buffer);
@@ -626,6 +1315,10 @@ void UART_HandleCommand(void)
         case 0x0602:
             CMD_0602_WriteBK4819Reg(UART_Command.Buffer);
             break;
+
+        case 0x0603:
+            CMD_0603_BenchBK4819(UART_Command.Buffer);
+            break;
 #endif
     }
 }
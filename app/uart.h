@@ -18,9 +18,24 @@
 #define APP_UART_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 bool UART_IsCommandAvailable(void);
 void UART_HandleCommand(void);
+#ifdef ENABLE_UART_TELEMETRY
+    // called every 10 ms, sends a frame when one is due
+    void UART_SendTelemetry(void);
+#endif
+#ifdef ENABLE_UART_BULK
+    // move the bulk read being sent into the TX queue, never waits
+    void UART_BulkPump(void);
+#endif
+#ifdef ENABLE_UART_SPECTRUM
+    // hand over a finished sweep, copied so the next one can start at once
+    void UART_SpectrumSweep(uint32_t FStart, uint16_t Step, uint16_t Count, const uint16_t *pRssi);
+    // move the frame being sent into the TX queue, never waits
+    void UART_SpectrumPump(void);
+#endif
 
 #endif
 
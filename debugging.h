@@ -9,9 +9,10 @@
 #include "external/printf/printf.h"
 #include "am_fix.h"
 
+// dropped rather than stalling the radio when the link can't keep up
 static inline void LogUart(const char *const str)
 {
-    UART_Send(str, strlen(str));
+    UART_SendAsync(str, strlen(str));
 }
 
 static inline void LogUartf(const char* format, ...)
@@ -21,7 +22,7 @@ static inline void LogUartf(const char* format, ...)
     va_start(va, format);
     vsnprintf(buffer, (size_t)-1, format, va);
     va_end(va);
-    UART_Send(buffer, strlen(buffer));
+    UART_SendAsync(buffer, strlen(buffer));
 }
 
 static inline void LogRegUart(uint16_t reg)
@@ -17,11 +17,13 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "ARMCM0.h"
 #include "settings.h"
 
 #include "../audio.h"
 #include "../bsp/dp32g030/gpio.h"
 #include "../bsp/dp32g030/portcon.h"
+#include "../misc.h"
 
 #include "bk4819.h"
 #include "gpio.h"
@@ -40,6 +42,27 @@ static const uint8_t DTMF_TONE2_GAIN = 93;
 
 static uint16_t gBK4819_GpioOutState;
 
+// RAM copy of the BK4819 register file. A write that matches the copy is
+// skipped and reads are answered from it, which takes most of the 24-bit
+// bit-banged transfers out of a channel hop. Status registers the chip
+// updates by itself, and ports that act on every write (soft reset,
+// interrupt acknowledge, indexed tables, FSK FIFO, RX/TX enable) always
+// go to the chip.
+static uint16_t gBK4819_Shadow[128];
+static uint32_t gBK4819_ShadowValid[128 / 32];
+
+static const uint32_t BK4819_Volatile[128 / 32] =
+{
+    (1u << 0x00) | (1u << 0x02) | (1u << 0x06) | (1u << 0x09) |     // REG_00 .. REG_1F
+    (1u << 0x0B) | (1u << 0x0C) | (1u << 0x0D) | (1u << 0x0E),
+    (1u << (0x30 - 0x20)),                                          // REG_20 .. REG_3F
+    (1u << (0x59 - 0x40)) | (1u << (0x5F - 0x40)),                  // REG_40 .. REG_5F
+    0x0000FFFFu | (1u << (0x7E - 0x60))                             // REG_60 .. REG_7F
+};
+
+uint32_t gBK4819_TransactionsIssued;
+uint32_t gBK4819_TransactionsElided;
+
 bool gRxIdleMode;
 
 __inline uint16_t scale_freq(const uint16_t freq)
@@ -124,23 +147,23 @@ void BK4819_Init(void)
     BK4819_WriteRegister(BK4819_REG_3F, 0);
 }
 
-static uint16_t BK4819_ReadU16(void)
+RAMFUNC static uint16_t BK4819_ReadU16(void)
 {
     unsigned int i;
     uint16_t     Value;
 
     PORTCON_PORTC_IE = (PORTCON_PORTC_IE & ~PORTCON_PORTC_IE_C2_MASK) | PORTCON_PORTC_IE_C2_BITS_ENABLE;
     GPIOC->DIR = (GPIOC->DIR & ~GPIO_DIR_2_MASK) | GPIO_DIR_2_BITS_INPUT;
-    SYSTICK_DelayUs(1);
+    SYSTICK_SpinUs(1);
     Value = 0;
     for (i = 0; i < 16; i++)
     {
         Value <<= 1;
         Value |= GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
         GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
         GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
     }
     PORTCON_PORTC_IE = (PORTCON_PORTC_IE & ~PORTCON_PORTC_IE_C2_MASK) | PORTCON_PORTC_IE_C2_BITS_DISABLE;
     GPIOC->DIR = (GPIOC->DIR & ~GPIO_DIR_2_MASK) | GPIO_DIR_2_BITS_OUTPUT;
@@ -148,53 +171,211 @@ static uint16_t BK4819_ReadU16(void)
     return Value;
 }
 
-uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
+RAMFUNC static bool BK4819_IsVolatile(BK4819_REGISTER_t Register)
 {
-    uint16_t Value;
+    return (BK4819_Volatile[Register / 32] >> (Register % 32)) & 1u;
+}
+
+RAMFUNC static bool BK4819_IsCached(BK4819_REGISTER_t Register)
+{
+    return !BK4819_IsVolatile(Register) && ((gBK4819_ShadowValid[Register / 32] >> (Register % 32)) & 1u);
+}
+
+// one 24-bit write frame, entered and left with SCN high and SCL low
+RAMFUNC static void BK4819_WriteFrame(uint8_t Register, uint16_t Data)
+{
+    GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+
+    BK4819_WriteU8(Register);
+    BK4819_WriteU16(Data);
+
+    SYSTICK_SpinUs(1);
 
+    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+
+    SYSTICK_SpinUs(1);
+
+    gBK4819_TransactionsIssued++;
+}
+
+RAMFUNC static void BK4819_BusAcquire(void)
+{
     GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
     GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
-    SYSTICK_DelayUs(1);
+    SYSTICK_SpinUs(1);
+}
+
+RAMFUNC static void BK4819_BusRelease(void)
+{
+    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+}
+
+// Writes queued between BK4819_BeginBatch() and BK4819_Commit(). Each
+// register appears once, in the order it was first written, and the whole
+// queue goes out with a single bus acquire/release.
+static struct
+{
+    uint8_t  Register;
+    uint16_t Data;
+} gBK4819_Batch[16];
+
+static uint8_t gBK4819_BatchCount;
+static uint8_t gBK4819_BatchDepth;
+
+RAMFUNC static void BK4819_FlushBatch(void)
+{
+    if (gBK4819_BatchCount == 0)
+        return;
+
+    BK4819_BusAcquire();
+    for (unsigned int i = 0; i < gBK4819_BatchCount; i++)
+        BK4819_WriteFrame(gBK4819_Batch[i].Register, gBK4819_Batch[i].Data);
+    BK4819_BusRelease();
+
+    gBK4819_BatchCount = 0;
+}
+
+void BK4819_BeginBatch(void)
+{
+    gBK4819_BatchDepth++;
+}
+
+void BK4819_Commit(void)
+{
+    if (gBK4819_BatchDepth > 0 && --gBK4819_BatchDepth == 0)
+        BK4819_FlushBatch();
+}
+
+RAMFUNC uint16_t BK4819_ReadRegisterRaw(BK4819_REGISTER_t Register)
+{
+    uint16_t Value;
+
+    Register &= 0x7F;
+
+    // whatever the chip reports may depend on writes still in the queue
+    BK4819_FlushBatch();
+
+    gBK4819_TransactionsIssued++;
+
+    BK4819_BusAcquire();
 
     GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
     BK4819_WriteU8(Register | 0x80);
     Value = BK4819_ReadU16();
     GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
 
-    SYSTICK_DelayUs(1);
+    SYSTICK_SpinUs(1);
 
-    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+    BK4819_BusRelease();
 
     return Value;
 }
 
-void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
+RAMFUNC uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 {
-    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-    GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+    uint16_t Value;
 
-    SYSTICK_DelayUs(1);
+    Register &= 0x7F;
 
-    GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
-    BK4819_WriteU8(Register);
+    if (BK4819_IsCached(Register)) {
+        gBK4819_TransactionsElided++;
+        return gBK4819_Shadow[Register];
+    }
 
-    SYSTICK_DelayUs(1);
+    Value = BK4819_ReadRegisterRaw(Register);
 
-    BK4819_WriteU16(Data);
+    gBK4819_Shadow[Register] = Value;
+    gBK4819_ShadowValid[Register / 32] |= 1u << (Register % 32);
 
-    SYSTICK_DelayUs(1);
+    return Value;
+}
 
-    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+RAMFUNC void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
+{
+    Register &= 0x7F;
 
-    SYSTICK_DelayUs(1);
+    if (BK4819_IsCached(Register) && gBK4819_Shadow[Register] == Data) {
+        gBK4819_TransactionsElided++;
+        return;
+    }
 
-    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-    GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+    if (Register == BK4819_REG_00) {
+        // soft reset puts every register back to its default
+        for (unsigned int i = 0; i < ARRAY_SIZE(gBK4819_ShadowValid); i++)
+            gBK4819_ShadowValid[i] = 0;
+    }
+    else {
+        gBK4819_Shadow[Register] = Data;
+        gBK4819_ShadowValid[Register / 32] |= 1u << (Register % 32);
+    }
+
+    if (gBK4819_BatchDepth > 0 && !BK4819_IsVolatile(Register)) {
+        unsigned int i;
+
+        for (i = 0; i < gBK4819_BatchCount && gBK4819_Batch[i].Register != Register; i++) {}
+
+        if (i == ARRAY_SIZE(gBK4819_Batch)) {
+            BK4819_FlushBatch();
+            i = 0;
+        }
+
+        gBK4819_Batch[i].Register = Register;
+        gBK4819_Batch[i].Data     = Data;
+
+        if (i == gBK4819_BatchCount)
+            gBK4819_BatchCount++;
+        else
+            gBK4819_TransactionsElided++;   // superseded a queued write
+
+        return;
+    }
+
+    // strobes and ports act on the chip as it is now, so queued writes go first
+    BK4819_FlushBatch();
+
+    BK4819_BusAcquire();
+    BK4819_WriteFrame(Register, Data);
+    BK4819_BusRelease();
+}
+
+static uint32_t BK4819_TicksSince(uint32_t Start)
+{
+    const uint32_t Now = SysTick->VAL;
+
+    return (Now <= Start) ? Start - Now : Start + SysTick->LOAD + 1 - Now;
+}
+
+void BK4819_Benchmark(BK4819_Bench_t *pBench, uint16_t Count)
+{
+    // REG_3F gets back what it already holds, so the radio is left alone
+    const uint16_t Mask = BK4819_ReadRegister(BK4819_REG_3F);
+
+    *pBench = (BK4819_Bench_t){0};
+
+    for (unsigned int i = 0; i < Count; i++) {
+        uint32_t Start = SysTick->VAL;
+        BK4819_BusAcquire();
+        BK4819_WriteFrame(BK4819_REG_3F, Mask);
+        BK4819_BusRelease();
+        pBench->WriteTicks += BK4819_TicksSince(Start);
+
+        Start = SysTick->VAL;
+        BK4819_ReadRegister(BK4819_REG_0C);
+        pBench->ReadTicks += BK4819_TicksSince(Start);
+
+        Start = SysTick->VAL;
+        SYSTICK_DelayUs(1);
+        pBench->PollTicks += BK4819_TicksSince(Start);
+
+        Start = SysTick->VAL;
+        SYSTICK_SpinUs(1);
+        pBench->SpinTicks += BK4819_TicksSince(Start);
+    }
 }
 
-void BK4819_WriteU8(uint8_t Data)
+RAMFUNC void BK4819_WriteU8(uint8_t Data)
 {
     unsigned int i;
 
@@ -206,18 +387,18 @@ void BK4819_WriteU8(uint8_t Data)
         else
             GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
         GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
 
         Data <<= 1;
 
         GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
     }
 }
 
-void BK4819_WriteU16(uint16_t Data)
+RAMFUNC void BK4819_WriteU16(uint16_t Data)
 {
     unsigned int i;
 
@@ -229,14 +410,14 @@ void BK4819_WriteU16(uint16_t Data)
         else
             GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
 
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
         GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
 
         Data <<= 1;
 
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
         GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
-        SYSTICK_DelayUs(1);
+        SYSTICK_SpinUs(1);
     }
 }
 
@@ -696,6 +877,8 @@ void BK4819_SetupSquelch(
         uint8_t SquelchCloseGlitchThresh,
         uint8_t SquelchOpenGlitchThresh)
 {
+    BK4819_BeginBatch();
+
     // REG_70
     //
     // <15>   0 Enable TONE1
@@ -767,6 +950,8 @@ void BK4819_SetupSquelch(
     BK4819_SetAF(BK4819_AF_MUTE);
 
     BK4819_RX_TurnOn();
+
+    BK4819_Commit();
 }
 
 void BK4819_SetAF(BK4819_AF_Type_t AF)
@@ -1444,7 +1629,7 @@ void BK4819_PlayCTCSSTail(void)
     BK4819_WriteRegister(BK4819_REG_51, 0x904A); // 1 0 0 1 0 0 0 0  0  1001010
 }
 
-uint16_t BK4819_GetRSSI(void)
+RAMFUNC uint16_t BK4819_GetRSSI(void)
 {
     return BK4819_ReadRegister(BK4819_REG_67) & 0x01FF;
 }
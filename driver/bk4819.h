@@ -65,9 +65,33 @@ typedef enum BK4819_CssScanResult_t BK4819_CssScanResult_t;
 // radio is asleep, not listening
 extern bool gRxIdleMode;
 
+// register transfers sent to the chip / answered from the shadow copy
+extern uint32_t gBK4819_TransactionsIssued;
+extern uint32_t gBK4819_TransactionsElided;
+
+// SysTick ticks spent by BK4819_Benchmark() on each kind of operation
+typedef struct {
+    uint32_t WriteTicks;    // raw register writes
+    uint32_t ReadTicks;     // raw register reads
+    uint32_t PollTicks;     // SYSTICK_DelayUs(1)
+    uint32_t SpinTicks;     // SYSTICK_SpinUs(1)
+} BK4819_Bench_t;
+
+// 1 us bus delays in one write / read transaction
+#define BK4819_WRITE_DELAYS 75
+#define BK4819_READ_DELAYS  59
+
 void     BK4819_Init(void);
 uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register);
+// from the chip even when the shadow has it, and the shadow left as it is
+uint16_t BK4819_ReadRegisterRaw(BK4819_REGISTER_t Register);
 void     BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data);
+void     BK4819_Benchmark(BK4819_Bench_t *pBench, uint16_t Count);
+
+// writes between these go out in one burst when the outermost commit runs
+void     BK4819_BeginBatch(void);
+void     BK4819_Commit(void);
+
 void     BK4819_SetRegValue(RegisterSpec s, uint16_t v);
 void     BK4819_WriteU8(uint8_t Data);
 void     BK4819_WriteU16(uint16_t Data);
@@ -47,3 +47,14 @@ uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size)
 
     return Crc;
 }
+
+uint16_t CRC_Update(uint16_t Crc, const void *pBuffer, uint16_t Size)
+{
+    // no reflection or inversion, so seeding the IV with the CRC so far
+    // gives the same result as one pass over the whole buffer
+    CRC_IV = Crc;
+    Crc    = CRC_Calculate(pBuffer, Size);
+    CRC_IV = 0;
+
+    return Crc;
+}
@@ -21,6 +21,8 @@
 
 void CRC_Init(void);
 uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size);
+// continue a CRC over the next piece of a longer buffer, start with 0
+uint16_t CRC_Update(uint16_t Crc, const void *pBuffer, uint16_t Size);
 
 #endif
 
@@ -19,10 +19,68 @@
 
 #include "driver/eeprom.h"
 #include "driver/i2c.h"
-#include "driver/system.h"
+#include "driver/systick.h"
+#include "misc.h"
 
-void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+// Write-back cache of 8-byte blocks. Writes land here and are burnt in one
+// block per 10 ms tick by EEPROM_FlushStep(), so a settings save no longer
+// stalls the UI for 8 ms per block.
+typedef struct {
+    uint16_t Address;
+    uint8_t  Data[8];
+} EEPROM_Block_t;
+
+static EEPROM_Block_t gEEPROM_Cache[EEPROM_CACHE_BLOCKS];
+static uint32_t       gEEPROM_CacheValid;   // one bit per slot
+static uint32_t       gEEPROM_CacheDirty;
+static uint8_t        gEEPROM_CacheVictim;
+
+// a write cycle was started and the chip has not ACKed since
+static bool           gEEPROM_Burning;
+
+// Append-only journal for the blocks rewritten on every VFO switch and scan
+// stop. A change goes to the next of the ring slots instead of its home
+// address, and the home is only written back once the ring is about to drop
+// the last record of it.
+typedef struct {
+    uint16_t Sequence;
+    uint8_t  Block;     // index of the hot block
+    uint8_t  Check;
+    uint8_t  Data[8];
+} EEPROM_Record_t;
+
+static uint8_t  gEEPROM_Hot[EEPROM_HOT_BLOCKS][8];     // current value of each hot block
+static uint8_t  gEEPROM_HotSlot[EEPROM_HOT_BLOCKS];    // slot of its latest record, 0xFF when home is current
+static uint8_t  gEEPROM_JournalNext;
+static uint16_t gEEPROM_JournalSequence;
+static bool     gEEPROM_JournalLoaded;
+
+bool EEPROM_IsBusy(void)
+{
+    if (!gEEPROM_Burning)
+        return false;
+
+    // the chip ignores its address until the write cycle is over
+    I2C_Start();
+    gEEPROM_Burning = I2C_Write(0xA0) != 0;
+    I2C_Stop();
+
+    return gEEPROM_Burning;
+}
+
+static void EEPROM_WaitBurn(void)
+{
+    // typically 3-5 ms, give up after 10 ms like the datasheet maximum
+    for (unsigned int i = 0; i < 100 && EEPROM_IsBusy(); i++)
+        SYSTICK_DelayUs(100);
+
+    gEEPROM_Burning = false;
+}
+
+static void EEPROM_ReadChip(uint16_t Address, void *pBuffer, uint8_t Size)
 {
+    EEPROM_WaitBurn();
+
     I2C_Start();
 
     I2C_Write(0xA0);
@@ -39,15 +97,12 @@ void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
     I2C_Stop();
 }
 
-void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer)
+// one write transaction, must not cross a page boundary
+static void EEPROM_WriteChip(uint16_t Address, const void *pBuffer, uint8_t Size)
 {
-    if (pBuffer == NULL || Address >= 0x2000)
-        return;
-
-
-    uint8_t buffer[8];
-    EEPROM_ReadBuffer(Address, buffer, 8);
-    if (memcmp(pBuffer, buffer, 8) == 0) {
+    uint8_t buffer[EEPROM_PAGE_SIZE];
+    EEPROM_ReadChip(Address, buffer, Size);
+    if (memcmp(pBuffer, buffer, Size) == 0) {
         return;
     }
 
@@ -55,9 +110,337 @@ void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer)
     I2C_Write(0xA0);
     I2C_Write((Address >> 8) & 0xFF);
     I2C_Write((Address >> 0) & 0xFF);
-    I2C_WriteBuffer(pBuffer, 8);
+    I2C_WriteBuffer(pBuffer, Size);
     I2C_Stop();
 
-    // give the EEPROM time to burn the data in (apparently takes 5ms)
-    SYSTEM_DelayMs(8);
+    // the next access polls until the chip has burnt the data in
+    gEEPROM_Burning = true;
+}
+
+static int EEPROM_HotIndex(unsigned int Block)
+{
+    // first half of each VFO record, frequency and offset
+    if (Block >= 0x0C80 && Block < 0x0D60)
+        return (Block % 16) ? -1 : (int)(Block - 0x0C80) / 16;
+
+    if (Block == 0x0E78)    // current state
+        return 14;
+    if (Block == 0x0E80)    // VFO channel indices
+        return 15;
+
+    return -1;
+}
+
+static uint16_t EEPROM_HotAddress(unsigned int Index)
+{
+    return (Index < 14) ? 0x0C80 + Index * 16 : 0x0E78 + (Index - 14) * 8;
+}
+
+// hot blocks and the ring itself never reach the chip through the normal path
+static bool EEPROM_IsJournalled(unsigned int Address)
+{
+    if (Address >= EEPROM_JOURNAL_BASE && Address < EEPROM_JOURNAL_BASE + EEPROM_JOURNAL_SLOTS * 16)
+        return true;
+
+    return EEPROM_HotIndex(Address & ~7u) >= 0;
+}
+
+static uint8_t EEPROM_RecordCheck(const EEPROM_Record_t *pRecord)
+{
+    uint8_t Sum = pRecord->Sequence + (pRecord->Sequence >> 8) + pRecord->Block;
+
+    for (unsigned int i = 0; i < 8; i++)
+        Sum += pRecord->Data[i];
+
+    return ~Sum;
+}
+
+void EEPROM_ReplayJournal(void)
+{
+    EEPROM_Record_t Record;
+    uint16_t        Sequence[EEPROM_HOT_BLOCKS] = {0};
+    uint16_t        Newest = 0;
+    bool            bFound = false;
+
+    if (gEEPROM_JournalLoaded)
+        return;
+
+    gEEPROM_JournalLoaded = true;
+
+    for (unsigned int i = 0; i < EEPROM_HOT_BLOCKS; i++) {
+        EEPROM_ReadChip(EEPROM_HotAddress(i), gEEPROM_Hot[i], 8);
+        gEEPROM_HotSlot[i] = 0xFF;
+    }
+
+    // sequence numbers wrap, but all live records are within one ring of each other
+    for (unsigned int Slot = 0; Slot < EEPROM_JOURNAL_SLOTS; Slot++) {
+        EEPROM_ReadChip(EEPROM_JOURNAL_BASE + Slot * 16, &Record, sizeof(Record));
+
+        if (Record.Sequence == 0xFFFF || Record.Block >= EEPROM_HOT_BLOCKS || Record.Check != EEPROM_RecordCheck(&Record))
+            continue;
+
+        if (!bFound || (int16_t)(Record.Sequence - Newest) > 0) {
+            Newest              = Record.Sequence;
+            gEEPROM_JournalNext = (Slot + 1) % EEPROM_JOURNAL_SLOTS;
+            bFound              = true;
+        }
+
+        const unsigned int i = Record.Block;
+
+        if (gEEPROM_HotSlot[i] == 0xFF || (int16_t)(Record.Sequence - Sequence[i]) > 0) {
+            memcpy(gEEPROM_Hot[i], Record.Data, 8);
+            gEEPROM_HotSlot[i] = Slot;
+            Sequence[i]        = Record.Sequence;
+        }
+    }
+
+    gEEPROM_JournalSequence = bFound ? Newest + 1 : 0;
+    if (gEEPROM_JournalSequence == 0xFFFF)
+        gEEPROM_JournalSequence = 0;
+}
+
+static void EEPROM_JournalAppend(unsigned int Index)
+{
+    EEPROM_Record_t Record;
+    const uint8_t   Slot = gEEPROM_JournalNext;
+
+    // the slot may hold the only copy of another block, put that one home first
+    for (unsigned int i = 0; i < EEPROM_HOT_BLOCKS; i++) {
+        if (gEEPROM_HotSlot[i] != Slot)
+            continue;
+
+        if (i != Index)
+            EEPROM_WriteChip(EEPROM_HotAddress(i), gEEPROM_Hot[i], 8);
+
+        gEEPROM_HotSlot[i] = 0xFF;
+    }
+
+    Record.Sequence = gEEPROM_JournalSequence;
+    Record.Block    = Index;
+    memcpy(Record.Data, gEEPROM_Hot[Index], 8);
+    Record.Check    = EEPROM_RecordCheck(&Record);
+
+    EEPROM_WriteChip(EEPROM_JOURNAL_BASE + Slot * 16, &Record, sizeof(Record));
+
+    gEEPROM_HotSlot[Index] = Slot;
+    gEEPROM_JournalNext    = (Slot + 1) % EEPROM_JOURNAL_SLOTS;
+
+    if (++gEEPROM_JournalSequence == 0xFFFF)
+        gEEPROM_JournalSequence = 0;
+}
+
+// take the hot blocks out of a write, one record per block that changed
+static void EEPROM_JournalWrite(uint16_t Address, const uint8_t *pData, uint8_t Size)
+{
+    for (unsigned int i = 0; i < EEPROM_HOT_BLOCKS; i++) {
+        const unsigned int Block = EEPROM_HotAddress(i);
+        const unsigned int Start = MAX(Block, (unsigned int)Address);
+        const unsigned int End   = MIN(Block + 8, (unsigned int)Address + Size);
+
+        if (Start >= End || memcmp(&gEEPROM_Hot[i][Start - Block], &pData[Start - Address], End - Start) == 0)
+            continue;
+
+        memcpy(&gEEPROM_Hot[i][Start - Block], &pData[Start - Address], End - Start);
+        EEPROM_JournalAppend(i);
+    }
+}
+
+static int EEPROM_FindBlock(uint16_t Address)
+{
+    for (unsigned int i = 0; i < EEPROM_CACHE_BLOCKS; i++)
+        if ((gEEPROM_CacheValid >> i) & 1u && gEEPROM_Cache[i].Address == Address)
+            return i;
+
+    return -1;
+}
+
+static bool EEPROM_IsDirty(int Slot)
+{
+    return Slot >= 0 && ((gEEPROM_CacheDirty >> Slot) & 1u);
+}
+
+// burn in the block along with its dirty neighbours in the same page
+static void EEPROM_FlushBlock(unsigned int Slot)
+{
+    uint8_t  Page[EEPROM_PAGE_SIZE];
+    uint16_t Address = gEEPROM_Cache[Slot].Address;
+    uint8_t  Size    = 0;
+
+    while (Address % EEPROM_PAGE_SIZE && EEPROM_IsDirty(EEPROM_FindBlock(Address - 8)))
+        Address -= 8;
+
+    do {
+        Slot = EEPROM_FindBlock(Address + Size);
+        memcpy(&Page[Size], gEEPROM_Cache[Slot].Data, 8);
+        gEEPROM_CacheDirty &= ~(1u << Slot);
+        Size += 8;
+    } while ((Address + Size) % EEPROM_PAGE_SIZE && EEPROM_IsDirty(EEPROM_FindBlock(Address + Size)));
+
+    EEPROM_WriteChip(Address, Page, Size);
+}
+
+static unsigned int EEPROM_AllocBlock(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < EEPROM_CACHE_BLOCKS; i++)
+        if (!((gEEPROM_CacheValid >> i) & 1u))
+            return i;
+
+    // reuse a clean block, or burn one in if they are all dirty
+    for (i = 0; i < EEPROM_CACHE_BLOCKS; i++) {
+        const unsigned int Slot = gEEPROM_CacheVictim;
+
+        gEEPROM_CacheVictim = (gEEPROM_CacheVictim + 1) % EEPROM_CACHE_BLOCKS;
+
+        if (!((gEEPROM_CacheDirty >> Slot) & 1u))
+            return Slot;
+    }
+
+    const unsigned int Slot = gEEPROM_CacheVictim;
+
+    gEEPROM_CacheVictim = (gEEPROM_CacheVictim + 1) % EEPROM_CACHE_BLOCKS;
+    EEPROM_FlushBlock(Slot);
+
+    return Slot;
+}
+
+void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size)
+{
+    EEPROM_ReplayJournal();
+
+    const int Hot = EEPROM_HotIndex(Address & ~7u);
+
+    // read-modify-write of a hot block never has to touch the bus
+    if (Hot >= 0 && Address % 8 + Size <= 8) {
+        memcpy(pBuffer, &gEEPROM_Hot[Hot][Address % 8], Size);
+        return;
+    }
+
+    EEPROM_ReadChip(Address, pBuffer, Size);
+
+    // patch in whatever has not been burnt in yet
+    for (unsigned int i = 0; i < EEPROM_CACHE_BLOCKS; i++) {
+        if (!((gEEPROM_CacheDirty >> i) & 1u))
+            continue;
+
+        const unsigned int Block = gEEPROM_Cache[i].Address;
+        const unsigned int Start = MAX(Block, (unsigned int)Address);
+        const unsigned int End   = MIN(Block + 8, (unsigned int)Address + Size);
+
+        if (Start < End)
+            memcpy((uint8_t *)pBuffer + (Start - Address), &gEEPROM_Cache[i].Data[Start - Block], End - Start);
+    }
+
+    for (unsigned int i = 0; i < EEPROM_HOT_BLOCKS; i++) {
+        const unsigned int Block = EEPROM_HotAddress(i);
+        const unsigned int Start = MAX(Block, (unsigned int)Address);
+        const unsigned int End   = MIN(Block + 8, (unsigned int)Address + Size);
+
+        if (Start < End)
+            memcpy((uint8_t *)pBuffer + (Start - Address), &gEEPROM_Hot[i][Start - Block], End - Start);
+    }
+}
+
+void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer)
+{
+    if (pBuffer == NULL || Address >= 0x2000)
+        return;
+
+    if (Address % 8) {
+        // would straddle two cached blocks, go direct
+        EEPROM_WritePage(Address, pBuffer, 8);
+        return;
+    }
+
+    EEPROM_ReplayJournal();
+
+    if (EEPROM_IsJournalled(Address)) {
+        EEPROM_JournalWrite(Address, pBuffer, 8);
+        return;
+    }
+
+    int Slot = EEPROM_FindBlock(Address);
+
+    if (Slot >= 0) {
+        if (memcmp(gEEPROM_Cache[Slot].Data, pBuffer, 8) == 0)
+            return;
+    }
+    else {
+        Slot = EEPROM_AllocBlock();
+        gEEPROM_Cache[Slot].Address = Address;
+        gEEPROM_CacheValid |= 1u << Slot;
+    }
+
+    memcpy(gEEPROM_Cache[Slot].Data, pBuffer, 8);
+    gEEPROM_CacheDirty |= 1u << Slot;
+}
+
+void EEPROM_WritePage(uint16_t Address, const void *pBuffer, uint8_t Size)
+{
+    const uint8_t *pData = pBuffer;
+
+    if (pBuffer == NULL || Address + Size > 0x2000)
+        return;
+
+    EEPROM_ReplayJournal();
+    EEPROM_JournalWrite(Address, pData, Size);
+
+    // the chip gets the new data now, so cached copies must agree with it
+    for (unsigned int i = 0; i < EEPROM_CACHE_BLOCKS; i++) {
+        if (!((gEEPROM_CacheValid >> i) & 1u))
+            continue;
+
+        const unsigned int Block = gEEPROM_Cache[i].Address;
+        const unsigned int Start = MAX(Block, (unsigned int)Address);
+        const unsigned int End   = MIN(Block + 8, (unsigned int)Address + Size);
+
+        if (Start >= End)
+            continue;
+
+        memcpy(&gEEPROM_Cache[i].Data[Start - Block], &pData[Start - Address], End - Start);
+
+        if (End - Start == 8)
+            gEEPROM_CacheDirty &= ~(1u << i);
+    }
+
+    while (Size > 0) {
+        uint8_t    Chunk      = MIN(Size, EEPROM_PAGE_SIZE - Address % EEPROM_PAGE_SIZE);
+        const bool bJournalled = EEPROM_IsJournalled(Address);
+
+        // stop at the next block that goes the other way
+        for (uint8_t n = 8 - Address % 8; n < Chunk; n += 8) {
+            if (EEPROM_IsJournalled(Address + n) != bJournalled) {
+                Chunk = n;
+                break;
+            }
+        }
+
+        if (!bJournalled)
+            EEPROM_WriteChip(Address, pData, Chunk);
+
+        Address += Chunk;
+        pData   += Chunk;
+        Size    -= Chunk;
+    }
+}
+
+void EEPROM_FlushStep(void)
+{
+    if (gEEPROM_CacheDirty == 0)
+        return;
+
+    // don't block the tick on a burn still in progress, try again next time
+    if (EEPROM_IsBusy())
+        return;
+
+    EEPROM_FlushBlock(__builtin_ctz(gEEPROM_CacheDirty));
+}
+
+void EEPROM_Flush(void)
+{
+    while (gEEPROM_CacheDirty)
+        EEPROM_FlushBlock(__builtin_ctz(gEEPROM_CacheDirty));
+
+    EEPROM_WaitBurn();
 }
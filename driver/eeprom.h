@@ -17,10 +17,35 @@
 #ifndef DRIVER_EEPROM_H
 #define DRIVER_EEPROM_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+// 8-byte blocks held back by the write cache, at most 32
+#define EEPROM_CACHE_BLOCKS  16
+// bytes the chip takes in one write cycle
+#define EEPROM_PAGE_SIZE     32
+
+// VFO frequencies, current state and VFO indices, kept in a journal
+#define EEPROM_HOT_BLOCKS    16
+// ring of 16-byte records in the spare space after the DTMF contacts
+#define EEPROM_JOURNAL_BASE  0x1D00
+#define EEPROM_JOURNAL_SLOTS 16
+
 void EEPROM_ReadBuffer(uint16_t Address, void *pBuffer, uint8_t Size);
 void EEPROM_WriteBuffer(uint16_t Address, const void *pBuffer);
+// write straight through, one write cycle per page touched
+void EEPROM_WritePage(uint16_t Address, const void *pBuffer, uint8_t Size);
+
+// load the hot blocks and replay the journal over them, once at boot
+void EEPROM_ReplayJournal(void);
+
+// last write is still being burnt in, polls the chip without waiting
+bool EEPROM_IsBusy(void);
+
+// burn in one cached block, called every 10 ms
+void EEPROM_FlushStep(void);
+// burn in everything, before a reset or when power may go
+void EEPROM_Flush(void);
 
 #endif
 
@@ -118,7 +118,7 @@ KEY_Code_t KEYBOARD_Poll(void)
 
         // Read all 4 GPIO pins at once .. with de-noise, max of 8 sample loops
         for (i = 0, k = 0, reg = 0; i < 3 && k < 8; i++, k++) {
-            SYSTICK_DelayUs(1);
+            SYSTICK_SpinUs(1);
             uint16_t reg2 = GPIOA->DATA;
             i *= reg == reg2;
             reg = reg2;
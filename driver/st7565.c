@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include <stdio.h>     // NULL
+#include <string.h>
 
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/spi.h"
@@ -28,8 +29,17 @@
 uint8_t gStatusLine[LCD_WIDTH];
 uint8_t gFrameBuffer[FRAME_LINES][LCD_WIDTH];
 
+uint32_t gST7565_BytesSent;
+
+// What the panel shows right now, so a blit only sends the changed span of
+// each page. A page whose bit is clear in gShownValid is sent in full.
+static uint8_t gShownPages[1 + FRAME_LINES][LCD_WIDTH];
+static uint8_t gShownValid;
+
 static void DrawLine(uint8_t column, uint8_t line, const uint8_t * lineBuffer, unsigned size_defVal)
 {   
+    gST7565_BytesSent += 3 + size_defVal;
+
     ST7565_SelectColumnAndLine(column + 4, line);
     GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0);
     for (unsigned i = 0; i < size_defVal; i++) {
@@ -39,8 +49,36 @@ static void DrawLine(uint8_t column, uint8_t line, const uint8_t * lineBuffer, u
     SPI_WaitForUndocumentedTxFifoStatusBit();
 }
 
+static void BlitPage(uint8_t line, const uint8_t *pBuffer)
+{
+    uint8_t  *pShown = gShownPages[line];
+    unsigned first   = 0;
+    unsigned last    = LCD_WIDTH;
+
+    if ((gShownValid >> line) & 1u) {
+        while (first < LCD_WIDTH && pShown[first] == pBuffer[first])
+            first++;
+
+        if (first == LCD_WIDTH)
+            return;
+
+        while (pShown[last - 1] == pBuffer[last - 1])
+            last--;
+    }
+
+    DrawLine(first, line, &pBuffer[first], last - first);
+
+    memcpy(&pShown[first], &pBuffer[first], last - first);
+    gShownValid |= 1u << line;
+}
+
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const uint8_t *pBitmap, const unsigned int Size)
 {
+    if (Line <= FRAME_LINES && pBitmap != NULL && Column + Size <= LCD_WIDTH)
+        memcpy(&gShownPages[Line][Column], pBitmap, Size);
+    else if (Line <= FRAME_LINES)
+        gShownValid &= ~(1u << Line);
+
     SPI_ToggleMasterMode(&SPI0->CR, false);
     DrawLine(Column, Line, pBitmap, Size);
     SPI_ToggleMasterMode(&SPI0->CR, true);
@@ -62,16 +100,16 @@ void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const u
 
         if(line == 0)
         {
-            DrawLine(0, 0, gStatusLine, LCD_WIDTH);
+            BlitPage(0, gStatusLine);
         }
         else if(line <= FRAME_LINES)
         {
-            DrawLine(0, line, gFrameBuffer[line - 1], LCD_WIDTH);
+            BlitPage(line, gFrameBuffer[line - 1]);
         }
         else
         {
             for (line = 1; line <= FRAME_LINES; line++) {
-                DrawLine(0, line, gFrameBuffer[line - 1], LCD_WIDTH);
+                BlitPage(line, gFrameBuffer[line - 1]);
             }
         }
 
@@ -98,7 +136,7 @@ void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const u
         SPI_ToggleMasterMode(&SPI0->CR, false);
         ST7565_WriteByte(0x40);
         for (unsigned line = 0; line < FRAME_LINES; line++) {
-            DrawLine(0, line+1, gFrameBuffer[line], LCD_WIDTH);
+            BlitPage(line+1, gFrameBuffer[line]);
         }
         SPI_ToggleMasterMode(&SPI0->CR, true);
     }
@@ -107,7 +145,7 @@ void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const u
     {
         SPI_ToggleMasterMode(&SPI0->CR, false);
         ST7565_WriteByte(0x40);    // start line ?
-        DrawLine(0, line+1, gFrameBuffer[line], LCD_WIDTH);
+        BlitPage(line+1, gFrameBuffer[line]);
         SPI_ToggleMasterMode(&SPI0->CR, true);
     }
 
@@ -115,7 +153,7 @@ void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const u
     {   // the top small text line on the display
         SPI_ToggleMasterMode(&SPI0->CR, false);
         ST7565_WriteByte(0x40);    // start line ?
-        DrawLine(0, 0, gStatusLine, LCD_WIDTH);
+        BlitPage(0, gStatusLine);
         SPI_ToggleMasterMode(&SPI0->CR, true);
     }
 #endif
@@ -127,6 +165,8 @@ void ST7565_FillScreen(uint8_t value)
         DrawLine(0, i, NULL, value);
     }
     SPI_ToggleMasterMode(&SPI0->CR, true);
+
+    gShownValid = 0;
 }
 
 // Software reset
@@ -292,6 +332,9 @@ void ST7565_Init(void)
 
 void ST7565_FixInterfGlitch(void)
 {
+    // the panel RAM may be garbled as well, resend everything on the next blit
+    gShownValid = 0;
+
     SPI_ToggleMasterMode(&SPI0->CR, false);
     for(uint8_t i = 0; i < ARRAY_SIZE(cmds); i++)
 #ifdef ENABLE_FEAT_F4HWN
@@ -305,6 +348,8 @@ void ST7565_FixInterfGlitch(void)
 
 void ST7565_HardwareReset(void)
 {
+    gShownValid = 0;
+
     GPIO_SetBit(&GPIOB->DATA, GPIOB_PIN_ST7565_RES);
     SYSTEM_DelayMs(1);
     GPIO_ClearBit(&GPIOB->DATA, GPIOB_PIN_ST7565_RES);
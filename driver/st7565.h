@@ -27,6 +27,9 @@
 extern uint8_t gStatusLine[LCD_WIDTH];
 extern uint8_t gFrameBuffer[FRAME_LINES][LCD_WIDTH];
 
+// bytes sent to the panel, commands included, for measuring blit savings
+extern uint32_t gST7565_BytesSent;
+
 void ST7565_DrawLine(const unsigned int Column, const unsigned int Line, const uint8_t *pBitmap, const unsigned int Size);
 void ST7565_BlitFullScreen(void);
 void ST7565_BlitLine(unsigned line);
@@ -19,6 +19,9 @@
 
 #include <stdint.h>
 
+// core clock set up by SYSTEM_ConfigureClocks(), also feeds SysTick
+#define SYSTEM_CLOCK_MHZ 48
+
 void SYSTEM_DelayMs(uint32_t Delay);
 void SYSTEM_ConfigureClocks(void);
 
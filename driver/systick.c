@@ -15,16 +15,57 @@
  */
 
 #include "ARMCM0.h"
+#include "system.h"
 #include "systick.h"
 #include "../misc.h"
 
 // 0x20000324
 static uint32_t gTickMultiplier;
 
+// SUBS + taken BNE with no wait states. Fetching the loop from flash only
+// makes it slower, so the default can only make a delay longer.
+#define SPIN_CYCLES     4
+#define SPIN_CAL_LOOPS  1000
+
+uint8_t gSysTickSpinPerUs = SYSTEM_CLOCK_MHZ / SPIN_CYCLES;
+
+#ifdef ENABLE_TICKLESS_IDLE
+    #define TICK_CYCLES (SYSTEM_CLOCK_MHZ * 10000)
+
+    uint32_t gSysTickSkipped;
+
+    static uint8_t  gSleepTicks;    // 10 ms ticks the running period spans, 0 when it is a normal one
+    static uint32_t gIdleCycles;
+    static uint32_t gWindowTicks;
+#endif
+
+// Times the loop where this function runs, which has to be where the
+// SYSTICK_Spin() callers run, as the flash wait states change the figure.
+// With ENABLE_RAMFUNC the bus drivers spin from SRAM, so this goes there
+// too, and the keypad scan left in flash waits a little longer than asked.
+RAMFUNC __attribute__((noinline)) static uint32_t SYSTICK_TimeSpin(void)
+{
+    const uint32_t Start = SysTick->VAL;
+
+    SYSTICK_Spin(SPIN_CAL_LOOPS);
+
+    const uint32_t End = SysTick->VAL;
+
+    return (End <= Start) ? Start - End : Start + SysTick->LOAD + 1 - End;
+}
+
 void SYSTICK_Init(void)
 {
-    SysTick_Config(480000);
-    gTickMultiplier = 48;
+    SysTick_Config(SYSTEM_CLOCK_MHZ * 10000);
+    gTickMultiplier = SYSTEM_CLOCK_MHZ;
+
+    // best of two, in case an interrupt landed in one of them
+    const uint32_t Ticks = MAX(MIN(SYSTICK_TimeSpin(), SYSTICK_TimeSpin()), 1u);
+
+    // round up so a delay is never shorter than asked for
+    const uint32_t PerUs = (SPIN_CAL_LOOPS * SYSTEM_CLOCK_MHZ + Ticks - 1) / Ticks;
+
+    gSysTickSpinPerUs = MIN(PerUs, (uint32_t)SYSTEM_CLOCK_MHZ);
 }
 
 void SYSTICK_DelayUs(uint32_t Delay)
@@ -47,3 +88,78 @@ void SYSTICK_DelayUs(uint32_t Delay)
         Previous = Current;
     } while (elapsed_ticks < ticks);
 }
+
+#ifdef ENABLE_TICKLESS_IDLE
+void SYSTICK_Sleep(uint32_t Ticks)
+{
+    uint32_t Before = SysTick->VAL;
+
+    // stretch the period that is running so it ends Ticks - 1 ticks later,
+    // unless it is about to end or already has
+    if (Ticks > 1 && Before > TICK_CYCLES / 10 && !(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+        SysTick->LOAD = (Ticks - 1) * TICK_CYCLES + Before - 1;
+        SysTick->VAL  = 0;
+        gSleepTicks   = Ticks;
+        Before        = SysTick->LOAD;
+    }
+
+    // wakes on a pending interrupt even though it is masked, so the time
+    // asleep can be read before the handler runs
+    __WFI();
+
+    const uint32_t After = SysTick->VAL;
+
+    if (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)
+        gIdleCycles += Before + SysTick->LOAD - After;
+    else
+        gIdleCycles += Before - After;
+}
+
+uint32_t SYSTICK_Wake(void)
+{
+    uint32_t Ticks = 1;
+
+    if (gSleepTicks) {
+        // back to 10 ms, the few cycles since the reload are lost
+        SysTick->LOAD    = TICK_CYCLES - 1;
+        SysTick->VAL     = 0;
+        Ticks            = gSleepTicks;
+        gSleepTicks      = 0;
+        gSysTickSkipped += Ticks - 1;
+    }
+
+    gWindowTicks += Ticks;
+
+    return Ticks;
+}
+
+uint8_t SYSTICK_IdlePercent(void)
+{
+    const uint32_t Window = gWindowTicks * (TICK_CYCLES / 100);
+    const uint8_t  Percent = Window ? MIN(gIdleCycles / Window, 100u) : 0;
+
+    gIdleCycles  = 0;
+    gWindowTicks = 0;
+
+    return Percent;
+}
+#endif
+
+#ifdef ENABLE_PROFILER
+uint32_t SYSTICK_GetUs(void)
+{
+    uint32_t Ticks;
+    uint32_t Val;
+
+    do {
+        Ticks = gGlobalSysTickCounter;
+        Val   = SysTick->VAL;
+    } while (Ticks != gGlobalSysTickCounter);
+
+    // reloaded but the interrupt is held off, as in UART_HandleCommand()
+    if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && Val > SysTick->LOAD / 2)
+        Ticks++;
+
+    return Ticks * 10000 + (SysTick->LOAD - Val) / SYSTEM_CLOCK_MHZ;
+}
+#endif
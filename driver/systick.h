@@ -19,8 +19,57 @@
 
 #include <stdint.h>
 
+// loops of SYSTICK_Spin() per microsecond, measured by SYSTICK_Init() from
+// the same memory the spinning code runs from. A loop fetched from slower
+// memory than that takes longer, so its delays only come out longer.
+extern uint8_t gSysTickSpinPerUs;
+
 void SYSTICK_Init(void);
 void SYSTICK_DelayUs(uint32_t Delay);
 
+#ifdef ENABLE_PROFILER
+    // microseconds since boot from the tick count and SysTick, wraps after 71 minutes
+    uint32_t SYSTICK_GetUs(void);
+#endif
+
+#ifdef ENABLE_TICKLESS_IDLE
+    // 10 ms ticks that passed without an interrupt
+    extern uint32_t gSysTickSkipped;
+
+    // WFI until the next interrupt, with interrupts disabled. Ticks > 1 lets
+    // the SysTick interrupt skip that many ticks minus one.
+    void     SYSTICK_Sleep(uint32_t Ticks);
+    // from the SysTick handler, returns the ticks that have gone by
+    uint32_t SYSTICK_Wake(void);
+    // time spent in SYSTICK_Sleep() since the last call
+    uint8_t  SYSTICK_IdlePercent(void);
+#endif
+
+// Short busy-waits for the bit-banged buses. Polling SysTick costs more
+// than the microsecond being waited for, so these count down a register
+// instead. Loops must be non-zero.
+#ifdef __arm__
+static inline __attribute__((always_inline)) void SYSTICK_Spin(uint32_t Loops)
+{
+    __asm volatile (
+        "1: subs %0, #1 \n"
+        "   bne  1b     \n"
+        : "+l" (Loops) : : "cc");
+}
+#else
+void SYSTICK_Spin(uint32_t Loops);
+#endif
+
+static inline __attribute__((always_inline)) void SYSTICK_SpinUs(uint32_t Delay)
+{
+    SYSTICK_Spin(Delay * gSysTickSpinPerUs);
+}
+
+// Delay < 1000, rounded up to whole loops
+static inline __attribute__((always_inline)) void SYSTICK_SpinNs(uint32_t Delay)
+{
+    SYSTICK_Spin(((Delay * gSysTickSpinPerUs * 1049u) >> 20) + 1);
+}
+
 #endif
 
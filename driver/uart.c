@@ -15,13 +15,24 @@
  */
 
 #include <stdbool.h>
+#include "ARMCM0.h"
 #include "bsp/dp32g030/dma.h"
+#include "bsp/dp32g030/irq.h"
 #include "bsp/dp32g030/syscon.h"
 #include "bsp/dp32g030/uart.h"
+#include "driver/systick.h"
 #include "driver/uart.h"
 
 static bool UART_IsLogEnabled;
-uint8_t UART_DMA_Buffer[256];
+
+// TX queue, filled by the main loop and drained into the FIFO by
+// HandlerUART1() whenever the FIFO runs low
+static uint8_t           gUART_TxQueue[UART_TX_QUEUE_SIZE];
+static volatile uint16_t gUART_TxHead;
+static volatile uint16_t gUART_TxTail;
+
+uint32_t gUART_TxOverflow;
+uint8_t UART_DMA_Buffer[UART_RX_BUFFER_SIZE];
 
 void UART_Init(void)
 {
@@ -43,7 +54,7 @@ void UART_Init(void)
     UART1->CTRL = UART_CTRL_RXEN_BITS_ENABLE | UART_CTRL_TXEN_BITS_ENABLE | UART_CTRL_RXDMAEN_BITS_ENABLE;
     UART1->RXTO = 4;
     UART1->FC = 0;
-    UART1->FIFO = UART_FIFO_RF_LEVEL_BITS_8_BYTE | UART_FIFO_RF_CLR_BITS_ENABLE | UART_FIFO_TF_CLR_BITS_ENABLE;
+    UART1->FIFO = UART_FIFO_RF_LEVEL_BITS_8_BYTE | UART_FIFO_TF_LEVEL_BITS_4_BYTE | UART_FIFO_RF_CLR_BITS_ENABLE | UART_FIFO_TF_CLR_BITS_ENABLE;
     UART1->IE = 0;
 
     DMA_CTR = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_DISABLE;
@@ -73,7 +84,7 @@ void UART_Init(void)
         ;
     DMA_CH0->CTR = 0
         | DMA_CH_CTR_CH_EN_BITS_ENABLE
-        | ((0xFF << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
+        | (((UART_RX_BUFFER_SIZE - 1) << DMA_CH_CTR_LENGTH_SHIFT) & DMA_CH_CTR_LENGTH_MASK)
         | DMA_CH_CTR_LOOP_BITS_ENABLE
         | DMA_CH_CTR_PRI_BITS_MEDIUM
         ;
@@ -82,20 +93,116 @@ void UART_Init(void)
     DMA_CTR = (DMA_CTR & ~DMA_CTR_DMAEN_MASK) | DMA_CTR_DMAEN_BITS_ENABLE;
 
     UART1->CTRL |= UART_CTRL_UARTEN_BITS_ENABLE;
+
+    NVIC_EnableIRQ((IRQn_Type)DP32_UART1_IRQn);
+}
+
+uint32_t UART_TxFree(void)
+{
+    return (gUART_TxTail - gUART_TxHead - 1u) % UART_TX_QUEUE_SIZE;
+}
+
+// move queued bytes into the FIFO until it is full
+static void UART_TxPump(void)
+{
+    uint16_t Tail = gUART_TxTail;
+
+    while (Tail != gUART_TxHead && (UART1->IF & UART_IF_TXFIFO_FULL_MASK) == UART_IF_TXFIFO_FULL_BITS_NOT_SET) {
+        UART1->TDR = gUART_TxQueue[Tail];
+        Tail = (Tail + 1) % UART_TX_QUEUE_SIZE;
+    }
+
+    gUART_TxTail = Tail;
+
+    if (Tail == gUART_TxHead)
+        UART1->IE &= ~UART_IE_TXFIFO_MASK;
+}
+
+void HandlerUART1(void)
+{
+    UART_TxPump();
+}
+
+static void UART_TxQueue(const uint8_t *pData, uint32_t Size)
+{
+    uint16_t Head = gUART_TxHead;
+
+    while (Size--) {
+        gUART_TxQueue[Head] = *pData++;
+        Head = (Head + 1) % UART_TX_QUEUE_SIZE;
+    }
+
+    gUART_TxHead = Head;
+    UART1->IE |= UART_IE_TXFIFO_BITS_ENABLE;
+}
+
+// drain from the main loop, for when interrupts are off (UART_HandleCommand)
+// or the queue is full
+static void UART_TxWait(void)
+{
+    const uint16_t Tail = gUART_TxTail;
+
+    UART1->IE &= ~UART_IE_TXFIFO_MASK;
+    UART_TxPump();
+
+    // FIFO full, one character time at 38400 baud
+    if (gUART_TxTail == Tail)
+        SYSTICK_DelayUs(260);
+
+    if (gUART_TxTail != gUART_TxHead)
+        UART1->IE |= UART_IE_TXFIFO_BITS_ENABLE;
+}
+
+bool UART_SendAsync(const void *pBuffer, uint32_t Size)
+{
+    if (Size > UART_TxFree()) {
+        gUART_TxOverflow += Size;
+        return false;
+    }
+
+    UART_TxQueue(pBuffer, Size);
+
+    return true;
+}
+
+uint32_t UART_SendSome(const void *pBuffer, uint32_t Size)
+{
+    const uint32_t Free = UART_TxFree();
+
+    if (Size > Free)
+        Size = Free;
+
+    if (Size > 0)
+        UART_TxQueue(pBuffer, Size);
+
+    return Size;
 }
 
 void UART_Send(const void *pBuffer, uint32_t Size)
 {
     const uint8_t *pData = (const uint8_t *)pBuffer;
-    uint32_t i;
 
-    for (i = 0; i < Size; i++) {
-        UART1->TDR = pData[i];
-        while ((UART1->IF & UART_IF_TXFIFO_FULL_MASK) != UART_IF_TXFIFO_FULL_BITS_NOT_SET) {
+    while (Size > 0) {
+        const uint32_t Free  = UART_TxFree();
+        const uint32_t Chunk = (Size < Free) ? Size : Free;
+
+        if (Chunk == 0) {
+            UART_TxWait();
+            continue;
         }
+
+        UART_TxQueue(pData, Chunk);
+        pData += Chunk;
+        Size  -= Chunk;
     }
 }
 
+void UART_Flush(void)
+{
+    while (gUART_TxTail != gUART_TxHead)
+        UART_TxWait();
+}
+
 void UART_LogSend(const void *pBuffer, uint32_t Size)
 {
     if (UART_IsLogEnabled) {
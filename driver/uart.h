@@ -18,12 +18,34 @@
 #ifndef DRIVER_UART_H
 #define DRIVER_UART_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
-extern uint8_t UART_DMA_Buffer[256];
+#define UART_TX_QUEUE_SIZE 256
+
+#ifdef ENABLE_UART_BULK
+    // room for two bulk write frames in flight
+    #define UART_RX_BUFFER_SIZE 512
+#else
+    #define UART_RX_BUFFER_SIZE 256
+#endif
+
+extern uint8_t UART_DMA_Buffer[UART_RX_BUFFER_SIZE];
+
+// bytes UART_SendAsync() had to drop because the queue was full
+extern uint32_t gUART_TxOverflow;
 
 void UART_Init(void);
+// room left in the TX queue
+uint32_t UART_TxFree(void);
+// queue it all or drop it all, never waits
+bool UART_SendAsync(const void *pBuffer, uint32_t Size);
+// queue as much as fits, returns how many bytes that was
+uint32_t UART_SendSome(const void *pBuffer, uint32_t Size);
+// waits only while the queue is full
 void UART_Send(const void *pBuffer, uint32_t Size);
+// wait until the last byte has left the queue
+void UART_Flush(void);
 void UART_LogSend(const void *pBuffer, uint32_t Size);
 
 #endif
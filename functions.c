@@ -36,6 +36,7 @@
 #include "helper/battery.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/status.h"
 #include "ui/ui.h"
@@ -61,8 +62,8 @@ void FUNCTION_Init(void)
     gTailNoteEliminationCountdown_10ms = 0;
     gFoundCTCSS                        = false;
     gFoundCDCSS                        = false;
-    gFoundCTCSSCountdown_10ms          = 0;
-    gFoundCDCSSCountdown_10ms          = 0;
+    TIMER_Stop(TIMER_FOUND_CTCSS);
+    TIMER_Stop(TIMER_FOUND_CDCSS);
     gEndOfRxDetectedMaybe              = false;
 
     gCurrentCodeType = (gRxVfo->Modulation != MODULATION_FM) ? CODE_TYPE_OFF : gRxVfo->pRX->CodeType;
@@ -76,7 +77,7 @@ void FUNCTION_Init(void)
 #endif
 
 #ifdef ENABLE_NOAA
-    gNOAACountdown_10ms = 0;
+    TIMER_Stop(TIMER_NOAA_HOLD);
 
     if (IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE)) {
         gCurrentCodeType = CODE_TYPE_OFF;
@@ -121,14 +122,14 @@ void FUNCTION_PowerSave() {
     #ifdef ENABLE_FEAT_F4HWN_SLEEP
         if(gWakeUp)
         {
-            gPowerSave_10ms = gEeprom.BATTERY_SAVE * 200; // deep sleep now indexed on BatSav
+            TIMER_Arm(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 200); // deep sleep now indexed on BatSav
         }
         else
         {
-            gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+            TIMER_Arm(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 10);
         }
     #else
-        gPowerSave_10ms = gEeprom.BATTERY_SAVE * 10;
+        TIMER_Arm(TIMER_POWER_SAVE, gEeprom.BATTERY_SAVE * 10);
     #endif
     gPowerSaveCountdownExpired = false;
 
@@ -297,7 +298,7 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
         gMonitor = true;
     }
 
-    gBatterySaveCountdown_10ms = battery_save_count_10ms;
+    TIMER_Arm(TIMER_BATTERY_SAVE, battery_save_count_10ms);
     gSchedulePowerSave         = false;
 
 #if defined(ENABLE_FMRADIO)
@@ -48,8 +48,6 @@ typedef enum {
 uint16_t          lowBatteryCountdown;
 const uint16_t    lowBatteryPeriod = 30;
 
-volatile uint16_t gPowerSave_10ms;
-
 const uint16_t Voltage2PercentageTable[][7][3] = {
     [BATTERY_TYPE_1600_MAH] = {
         {828, 100},
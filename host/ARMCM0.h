@@ -0,0 +1,43 @@
+#ifndef HOST_ARMCM0_H
+#define HOST_ARMCM0_H
+
+// Stand-in for the CMSIS device header when building the host simulator.
+// Only the handful of core functions the firmware actually uses are
+// provided; the ones that touch the CPU are no-ops or call into the sim.
+
+#include <stdint.h>
+
+typedef enum IRQn {
+    SysTick_IRQn = -1,
+} IRQn_Type;
+
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t LOAD;
+    volatile uint32_t VAL;
+    volatile uint32_t CALIB;
+} SysTick_Type;
+
+extern SysTick_Type gSimSysTick;
+#define SysTick (&gSimSysTick)
+
+__attribute__((noreturn)) void SIM_SystemReset(void);
+
+static inline void __enable_irq(void)  {}
+static inline void __disable_irq(void) {}
+static inline void __NOP(void)         {}
+static inline void __DSB(void)         {}
+static inline void __ISB(void)         {}
+
+static inline uint32_t __get_PRIMASK(void)         { return 0; }
+static inline void     __set_PRIMASK(uint32_t Mask) { (void)Mask; }
+
+static inline void NVIC_EnableIRQ(IRQn_Type IRQn)  { (void)IRQn; }
+static inline void NVIC_DisableIRQ(IRQn_Type IRQn) { (void)IRQn; }
+
+__attribute__((noreturn)) static inline void NVIC_SystemReset(void)
+{
+    SIM_SystemReset();
+}
+
+#endif
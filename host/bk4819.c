@@ -0,0 +1,144 @@
+#include <stdlib.h>
+
+#include "bsp/dp32g030/gpio.h"
+#include "driver/bk4819-regs.h"
+#include "driver/gpio.h"
+#include "host/sim.h"
+
+// The firmware bit-bangs BK4819 on PC0 (SCN), PC1 (SCL) and PC2 (SDA) and
+// always waits between edges, so sampling the pins from SYSTICK_DelayUs()
+// sees every edge. A transaction is 8 address bits (bit 7 = read) followed
+// by 16 data bits, MSB first, latched on the rising edge of SCL.
+
+uint16_t      gSimBK4819_Regs[128];
+SIM_Carrier_t gSimCarriers[SIM_MAX_CARRIERS];
+unsigned int  gSimCarrierCount;
+int16_t       gSimNoiseFloor_dBm = -130;
+
+static struct {
+    bool     scn;
+    bool     scl;
+    bool     read;
+    bool     squelch_open;
+    uint8_t  bits;
+    uint8_t  addr;
+    uint16_t data;
+} bk = { .scn = true };
+
+static int16_t SignalAtTunedFrequency(void)
+{
+    const uint32_t Frequency = ((uint32_t)gSimBK4819_Regs[BK4819_REG_39] << 16) | gSimBK4819_Regs[BK4819_REG_38];
+    int16_t        dBm       = gSimNoiseFloor_dBm;
+
+    for (unsigned int i = 0; i < gSimCarrierCount; i++)
+        if (labs((long)gSimCarriers[i].frequency - (long)Frequency) < 1250 && gSimCarriers[i].dBm > dBm)
+            dBm = gSimCarriers[i].dBm;
+
+    return dBm;
+}
+
+static uint16_t RssiRegValue(void)
+{
+    const int rssi = (SignalAtTunedFrequency() + 160) * 2;
+    return rssi < 0 ? 0 : (rssi > 0x1FF ? 0x1FF : rssi);
+}
+
+static void UpdateSquelch(void)
+{
+    // REG_78 <15:8> is the RSSI open threshold, <7:0> the close threshold.
+    // Uncalibrated radios can end up with close above open; clamp it so the
+    // model keeps some hysteresis instead of toggling on every read.
+    const uint16_t rssi      = RssiRegValue();
+    const uint16_t sql       = gSimBK4819_Regs[BK4819_REG_78];
+    const uint16_t open_thr  = sql >> 8;
+    const uint16_t close_thr = (sql & 0xFF) < open_thr ? (sql & 0xFF) : open_thr;
+    const bool     open      = rssi >= (bk.squelch_open ? close_thr : open_thr);
+
+    if (open == bk.squelch_open)
+        return;
+
+    bk.squelch_open = open;
+
+    const uint16_t flag = open ? BK4819_REG_02_SQUELCH_FOUND : BK4819_REG_02_SQUELCH_LOST;
+    if (gSimBK4819_Regs[BK4819_REG_3F] & flag) {
+        gSimBK4819_Regs[BK4819_REG_02]  = flag;
+        gSimBK4819_Regs[BK4819_REG_0C] |= 1u;
+    }
+}
+
+static uint16_t ReadValue(uint8_t Register)
+{
+    switch (Register) {
+        case BK4819_REG_0C:
+            UpdateSquelch();
+            return (gSimBK4819_Regs[BK4819_REG_0C] & 1u) | (bk.squelch_open ? 0x0002 : 0);
+        case BK4819_REG_63:
+            return bk.squelch_open ? 0x0002 : 0x00F0;
+        case BK4819_REG_65:
+            return bk.squelch_open ? 0x0008 : 0x0050;
+        case BK4819_REG_67:
+            return RssiRegValue();
+        default:
+            return gSimBK4819_Regs[Register];
+    }
+}
+
+static void WriteValue(uint8_t Register, uint16_t Value)
+{
+    if (Register == BK4819_REG_02) {
+        // writing REG_02 acknowledges the pending interrupt request
+        gSimBK4819_Regs[BK4819_REG_0C] &= ~1u;
+        return;
+    }
+
+    gSimBK4819_Regs[Register] = Value;
+}
+
+void SIM_BK4819_Sample(void)
+{
+    const bool scn = GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCN);
+    const bool scl = GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SCL);
+    const bool sda = GPIO_CheckBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+
+    if (scn) {
+        if (!bk.scn && !bk.read && bk.bits == 24) {
+            WriteValue(bk.addr, bk.data);
+            gSimStats.bk4819_writes++;
+        }
+        bk.bits = 0;
+    }
+    else {
+        if (bk.scn) {
+            bk.bits = 0;
+            bk.read = false;
+        }
+
+        if (scl && !bk.scl && bk.bits < 24) {
+            if (bk.bits < 8) {
+                bk.addr = (bk.addr << 1) | sda;
+                if (bk.bits == 7) {
+                    bk.read  = (bk.addr & 0x80) != 0;
+                    bk.addr &= 0x7F;
+                    if (bk.read) {
+                        bk.data = ReadValue(bk.addr);
+                        gSimStats.bk4819_reads++;
+                    }
+                }
+            }
+            else if (!bk.read) {
+                bk.data = (bk.data << 1) | sda;
+            }
+            bk.bits++;
+        }
+
+        if (bk.read && bk.bits >= 8 && bk.bits < 24 && (GPIOC->DIR & GPIO_DIR_2_MASK) == GPIO_DIR_2_BITS_INPUT) {
+            if ((bk.data >> (23 - bk.bits)) & 1u)
+                GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+            else
+                GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_BK4819_SDA);
+        }
+    }
+
+    bk.scn = scn;
+    bk.scl = scl;
+}
@@ -0,0 +1,15 @@
+#ifndef HOST_BSP_DP32G030_SPI_H
+#define HOST_BSP_DP32G030_SPI_H
+
+// Picked up ahead of the real header in host builds. Every use of SPI0
+// goes through SIM_SPI0() so the panel model sees each byte written to
+// WDR, which a plain memory-mapped register could not tell it about.
+
+#include "../../../bsp/dp32g030/spi.h"
+
+volatile SPI_Port_t *SIM_SPI0(void);
+
+#undef  SPI0
+#define SPI0 (SIM_SPI0())
+
+#endif
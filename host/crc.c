@@ -0,0 +1,26 @@
+#include "driver/crc.h"
+
+// The DP32G030 CRC unit is set up for CRC-16/XMODEM (CCITT polynomial,
+// zero IV, no reflection), so the host build computes it in software.
+
+void CRC_Init(void)
+{
+}
+
+uint16_t CRC_Calculate(const void *pBuffer, uint16_t Size)
+{
+    return CRC_Update(0, pBuffer, Size);
+}
+
+uint16_t CRC_Update(uint16_t Crc, const void *pBuffer, uint16_t Size)
+{
+    const uint8_t *pData = (const uint8_t *)pBuffer;
+
+    for (uint16_t i = 0; i < Size; i++) {
+        Crc ^= pData[i] << 8;
+        for (unsigned int j = 0; j < 8; j++)
+            Crc = (Crc & 0x8000) ? (Crc << 1) ^ 0x1021 : Crc << 1;
+    }
+
+    return Crc;
+}
@@ -0,0 +1,168 @@
+#include <string.h>
+
+#include "bsp/dp32g030/gpio.h"
+#include "driver/gpio.h"
+#include "host/sim.h"
+
+// 24C64-style I2C EEPROM on PA10 (SCL) and PA11 (SDA). Like the BK4819
+// model it is clocked by pin samples taken whenever the firmware waits.
+// After a write cycle the part is busy for gSimEEPROM_WriteTimeUs and does
+// not acknowledge its address, exactly like the real chip.
+
+uint8_t  gSimEEPROM[SIM_EEPROM_SIZE];
+uint32_t gSimEEPROM_WriteTimeUs = 5000;
+
+enum {
+    I2C_IDLE,
+    I2C_DEVICE,
+    I2C_ADDR_HI,
+    I2C_ADDR_LO,
+    I2C_WRITE,
+    I2C_READ,
+    I2C_IGNORE
+};
+
+static struct {
+    bool     scl;
+    bool     sda;
+    uint8_t  state;
+    uint8_t  bits;          // rising SCL edges seen in the current byte, 9 = ACK clock
+    uint8_t  shift;
+    bool     ack;           // we drive SDA low during the ACK clock
+    bool     first;         // first byte of a read is already in shift
+    uint16_t address;
+    uint16_t page;
+    uint8_t  latched;
+    uint64_t busy_until;
+} ee = { .scl = true, .sda = true };
+
+void SIM_EEPROM_Init(void)
+{
+    memset(gSimEEPROM, 0xFF, sizeof(gSimEEPROM));
+}
+
+static void ByteReceived(uint8_t Byte)
+{
+    gSimStats.i2c_bytes++;
+    ee.ack = true;
+
+    switch (ee.state) {
+        case I2C_DEVICE:
+            if ((Byte & 0xFE) != 0xA0) {
+                ee.ack   = false;
+                ee.state = I2C_IGNORE;
+                break;
+            }
+            gSimStats.i2c_starts++;
+            if (gSimTimeUs < ee.busy_until) {
+                gSimStats.eeprom_nacks++;
+                ee.ack   = false;
+                ee.state = I2C_IGNORE;
+            }
+            else if (Byte & 1u) {
+                ee.state = I2C_READ;
+                ee.shift = gSimEEPROM[ee.address];
+                ee.first = true;
+            }
+            else
+                ee.state = I2C_ADDR_HI;
+            break;
+
+        case I2C_ADDR_HI:
+            ee.address = (Byte << 8) & (SIM_EEPROM_SIZE - 1);
+            ee.state   = I2C_ADDR_LO;
+            break;
+
+        case I2C_ADDR_LO:
+            ee.address |= Byte;
+            ee.page     = ee.address & ~(SIM_EEPROM_PAGE_SIZE - 1);
+            ee.latched  = 0;
+            ee.state    = I2C_WRITE;
+            break;
+
+        case I2C_WRITE:
+            // the address counter rolls over inside the current page
+            gSimEEPROM[ee.address] = Byte;
+            ee.address = ee.page | ((ee.address + 1) & (SIM_EEPROM_PAGE_SIZE - 1));
+            ee.latched++;
+            gSimStats.eeprom_bytes_written++;
+            break;
+
+        default:
+            ee.ack = false;
+            break;
+    }
+}
+
+static void DriveSda(bool level)
+{
+    if ((GPIOA->DIR & GPIO_DIR_11_MASK) != GPIO_DIR_11_BITS_INPUT)
+        return;
+
+    if (level)
+        GPIO_SetBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
+    else
+        GPIO_ClearBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
+}
+
+void SIM_EEPROM_Sample(void)
+{
+    const bool scl = GPIO_CheckBit(&GPIOA->DATA, GPIOA_PIN_I2C_SCL);
+    bool       sda = GPIO_CheckBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
+
+    if ((GPIOA->DIR & GPIO_DIR_11_MASK) == GPIO_DIR_11_BITS_INPUT)
+        sda = ee.sda;   // released by the master, only we drive it
+
+    if (scl && ee.scl && sda != ee.sda) {
+        if (!sda) {     // START (or repeated START)
+            ee.state = I2C_DEVICE;
+            ee.bits  = 0;
+            ee.ack   = false;
+        }
+        else {          // STOP
+            if (ee.state == I2C_WRITE && ee.latched > 0) {
+                gSimStats.eeprom_write_cycles++;
+                ee.busy_until = gSimTimeUs + gSimEEPROM_WriteTimeUs;
+            }
+            ee.state = I2C_IDLE;
+        }
+    }
+    else if (ee.state != I2C_IDLE && scl != ee.scl) {
+        if (scl) {
+            if (++ee.bits <= 8) {
+                if (ee.state != I2C_READ)
+                    ee.shift = (ee.shift << 1) | sda;
+                if (ee.bits == 8) {
+                    if (ee.state == I2C_READ)
+                        gSimStats.i2c_bytes++;
+                    else
+                        ByteReceived(ee.shift);
+                }
+            }
+            else if (ee.state == I2C_READ && sda) {
+                ee.state = I2C_IGNORE;  // master NACK ends the read
+            }
+        }
+        else if (ee.bits == 9) {
+            ee.bits = 0;
+            ee.ack  = false;
+            if (ee.state == I2C_READ) {
+                if (!ee.first) {
+                    ee.address = (ee.address + 1) & (SIM_EEPROM_SIZE - 1);
+                    ee.shift   = gSimEEPROM[ee.address];
+                }
+                ee.first = false;
+            }
+        }
+    }
+
+    if (ee.ack && ee.bits >= 8)
+        DriveSda(false);
+    else if (ee.state == I2C_READ && ee.bits < 8 + scl)
+        DriveSda((ee.shift >> (7 - (ee.bits - scl))) & 1u);
+    else
+        DriveSda(true);
+
+    ee.scl = scl;
+    ee.sda = GPIO_CheckBit(&GPIOA->DATA, GPIOA_PIN_I2C_SDA);
+}
@@ -0,0 +1,63 @@
+#include "bsp/dp32g030/gpio.h"
+#include "driver/gpio.h"
+#include "host/sim.h"
+
+// Keypad matrix: PA10..PA13 select a row (driven low), PA3..PA6 read the
+// columns through pull-ups. SIDE1/SIDE2 pull their column low directly.
+// PTT sits on PC5 and is active low.
+
+static const struct {
+    int8_t row;     // GPIOA pin, -1 for the side keys
+    int8_t column;  // GPIOA pin
+} Matrix[] = {
+    [KEY_MENU]  = { GPIOA_PIN_KEYBOARD_4, GPIOA_PIN_KEYBOARD_0 },
+    [KEY_1]     = { GPIOA_PIN_KEYBOARD_4, GPIOA_PIN_KEYBOARD_1 },
+    [KEY_4]     = { GPIOA_PIN_KEYBOARD_4, GPIOA_PIN_KEYBOARD_2 },
+    [KEY_7]     = { GPIOA_PIN_KEYBOARD_4, GPIOA_PIN_KEYBOARD_3 },
+    [KEY_UP]    = { GPIOA_PIN_KEYBOARD_5, GPIOA_PIN_KEYBOARD_0 },
+    [KEY_2]     = { GPIOA_PIN_KEYBOARD_5, GPIOA_PIN_KEYBOARD_1 },
+    [KEY_5]     = { GPIOA_PIN_KEYBOARD_5, GPIOA_PIN_KEYBOARD_2 },
+    [KEY_8]     = { GPIOA_PIN_KEYBOARD_5, GPIOA_PIN_KEYBOARD_3 },
+    [KEY_DOWN]  = { GPIOA_PIN_KEYBOARD_6, GPIOA_PIN_KEYBOARD_0 },
+    [KEY_3]     = { GPIOA_PIN_KEYBOARD_6, GPIOA_PIN_KEYBOARD_1 },
+    [KEY_6]     = { GPIOA_PIN_KEYBOARD_6, GPIOA_PIN_KEYBOARD_2 },
+    [KEY_9]     = { GPIOA_PIN_KEYBOARD_6, GPIOA_PIN_KEYBOARD_3 },
+    [KEY_EXIT]  = { GPIOA_PIN_KEYBOARD_7, GPIOA_PIN_KEYBOARD_0 },
+    [KEY_STAR]  = { GPIOA_PIN_KEYBOARD_7, GPIOA_PIN_KEYBOARD_1 },
+    [KEY_0]     = { GPIOA_PIN_KEYBOARD_7, GPIOA_PIN_KEYBOARD_2 },
+    [KEY_F]     = { GPIOA_PIN_KEYBOARD_7, GPIOA_PIN_KEYBOARD_3 },
+    [KEY_PTT]   = { -1, -1 },
+    [KEY_SIDE2] = { -1, GPIOA_PIN_KEYBOARD_1 },
+    [KEY_SIDE1] = { -1, GPIOA_PIN_KEYBOARD_0 },
+};
+
+static KEY_Code_t Pressed = KEY_INVALID;
+
+void SIM_KEYBOARD_Press(KEY_Code_t Key)
+{
+    Pressed = Key;
+}
+
+void SIM_KEYBOARD_Release(void)
+{
+    Pressed = KEY_INVALID;
+}
+
+void SIM_KEYBOARD_Sample(void)
+{
+    GPIOA->DATA |= 1u << GPIOA_PIN_KEYBOARD_0 |
+                   1u << GPIOA_PIN_KEYBOARD_1 |
+                   1u << GPIOA_PIN_KEYBOARD_2 |
+                   1u << GPIOA_PIN_KEYBOARD_3;
+
+    if (Pressed == KEY_PTT)
+        GPIO_ClearBit(&GPIOC->DATA, GPIOC_PIN_PTT);
+    else
+        GPIO_SetBit(&GPIOC->DATA, GPIOC_PIN_PTT);
+
+    if (Pressed >= KEY_INVALID || Matrix[Pressed].column < 0)
+        return;
+
+    if (Matrix[Pressed].row < 0 || !GPIO_CheckBit(&GPIOA->DATA, Matrix[Pressed].row))
+        GPIO_ClearBit(&GPIOA->DATA, Matrix[Pressed].column);
+}
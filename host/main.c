@@ -0,0 +1,607 @@
+// Host simulator entry point: maps the DP32G030 peripheral window into
+// ordinary memory, boots the firmware the same way Main() does and then
+// drives APP_Update()/APP_TimeSlice10ms() in virtual time.
+//
+//   host/build/uvk5-sim -t 60000 -k 1000:*:1500 -c 145500000:-70 -l
+
+#define _GNU_SOURCE     // mmap flags and getopt under -std=c2x
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef ENABLE_AM_FIX
+    #include "am_fix.h"
+#endif
+#include "app/app.h"
+#include "app/dtmf.h"
+#include "app/profiler.h"
+#include "bsp/dp32g030/saradc.h"
+#include "bsp/dp32g030/syscon.h"
+#include "board.h"
+#include "driver/backlight.h"
+#include "driver/bk4819.h"
+#include "driver/eeprom.h"
+#include "driver/system.h"
+#include "driver/systick.h"
+#ifdef ENABLE_UART
+    #include "driver/uart.h"
+#endif
+#include "helper/battery.h"
+#include "helper/boot.h"
+#include "misc.h"
+#include "radio.h"
+#include "scheduler.h"
+#include "settings.h"
+#include "ui/menu.h"
+#include "host/sim.h"
+
+#define PERIPHERAL_BASE 0x40000000UL
+#define PERIPHERAL_SIZE 0x000C0000UL
+
+SIM_Stats_t gSimStats;
+uint64_t    gSimEndUs = 10000000;
+
+static struct {
+    uint32_t   at_ms;
+    uint32_t   hold_ms;
+    KEY_Code_t key;
+} Keys[64];
+static unsigned int KeyCount;
+static unsigned int KeyNext;
+static uint64_t     KeyReleaseUs;
+
+static const char *EepromPath;
+static bool        bEepromWriteBack;
+static bool        bDumpLcd;
+static FILE       *pUartIn;
+static uint8_t     UartHeader[4];      // start of the command being fed
+static uint32_t    UartFed;
+static bool        bUartAwaitReply;
+static uint64_t    UartSentUs;
+static uint32_t    UartTxSeen;
+static bool        bUartLive;          // -p, a client on the other end of -i/-o
+static uint8_t     UartLiveBuf[65536];
+static uint32_t    UartLiveHead;
+static uint32_t    UartLiveTail;
+static uint32_t    UartLiveHoldIndex;  // bytes from here on answer the last TX
+static uint64_t    UartLiveHoldUs;     // and reach the line at this time
+static uint64_t    UartLiveActiveUs;
+static uint64_t    UartLiveSentUs;
+static bool        bUartLiveOwed;      // sent something, no answer yet
+static bool        bUartLiveEof;
+static uint32_t    UartLatencyUs = 10000;
+static const char *BenchSpec;
+
+static void MapPeripherals(void)
+{
+    void *p = mmap((void *)PERIPHERAL_BASE, PERIPHERAL_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+    if (p != (void *)PERIPHERAL_BASE) {
+        perror("sim: cannot map peripheral window");
+        exit(1);
+    }
+
+    // conversions are instantaneous; CH4 reads back as a 7.6 V battery
+    volatile ADC_Channel_t *pChannels = (volatile ADC_Channel_t *)&SARADC_CH0;
+    for (unsigned int i = 0; i < 16; i++)
+        pChannels[i].STAT = ADC_CHx_STAT_EOC_MASK;
+    pChannels[4].DATA = 2100;
+}
+
+static void LoadEeprom(void)
+{
+    static const uint16_t BatteryCalibration[6] = { 1900, 2000, 2050, 2100, 2150, 2300 };
+
+    SIM_EEPROM_Init();
+    memcpy(&gSimEEPROM[0x1F40], BatteryCalibration, sizeof(BatteryCalibration));
+
+    if (EepromPath == NULL)
+        return;
+
+    FILE *f = fopen(EepromPath, "rb");
+    if (f == NULL)
+        return;
+    if (fread(gSimEEPROM, 1, sizeof(gSimEEPROM), f) != sizeof(gSimEEPROM))
+        fprintf(stderr, "sim: %s is shorter than %u bytes\n", EepromPath, SIM_EEPROM_SIZE);
+    fclose(f);
+}
+
+static KEY_Code_t ParseKey(const char *s)
+{
+    static const struct {
+        const char *name;
+        KEY_Code_t  key;
+    } Names[] = {
+        {"M", KEY_MENU}, {"U", KEY_UP},  {"D", KEY_DOWN},   {"E", KEY_EXIT},
+        {"*", KEY_STAR}, {"F", KEY_F},   {"P", KEY_PTT},    {"S1", KEY_SIDE1},
+        {"S2", KEY_SIDE2},
+    };
+
+    if (s[0] >= '0' && s[0] <= '9' && s[1] == '\0')
+        return KEY_0 + (s[0] - '0');
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(Names); i++)
+        if (strcmp(s, Names[i].name) == 0)
+            return Names[i].key;
+
+    return KEY_INVALID;
+}
+
+// "at_ms:key[:hold_ms],..." e.g. "1000:*:1500,4000:E"
+static void ParseKeys(char *script)
+{
+    for (char *ev = strtok(script, ","); ev && KeyCount < ARRAY_SIZE(Keys); ev = strtok(NULL, ",")) {
+        char name[4] = {0};
+        unsigned int at, hold = 100;
+
+        if (sscanf(ev, "%u:%3[^:]:%u", &at, name, &hold) < 2 || ParseKey(name) == KEY_INVALID) {
+            fprintf(stderr, "sim: bad key event '%s'\n", ev);
+            exit(1);
+        }
+        Keys[KeyCount].at_ms   = at;
+        Keys[KeyCount].hold_ms = hold;
+        Keys[KeyCount].key     = ParseKey(name);
+        KeyCount++;
+    }
+}
+
+static void ParseCarrier(const char *s)
+{
+    unsigned long hz;
+    int           dBm;
+
+    if (gSimCarrierCount >= SIM_MAX_CARRIERS || sscanf(s, "%lu:%d", &hz, &dBm) != 2) {
+        fprintf(stderr, "sim: bad carrier '%s'\n", s);
+        exit(1);
+    }
+    gSimCarriers[gSimCarrierCount].frequency = hz / 10;
+    gSimCarriers[gSimCarrierCount].dBm       = dBm;
+    gSimCarrierCount++;
+}
+
+static void Usage(const char *argv0)
+{
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -t ms          virtual run time (default 10000)\n"
+        "  -e file        EEPROM image to load (8 KiB)\n"
+        "  -w             write the EEPROM image back on exit\n"
+        "  -k script      key events 'at_ms:key[:hold_ms],...'\n"
+        "                 keys 0-9 M U D E * F P S1 S2\n"
+        "  -c hz:dBm      add a carrier (repeatable)\n"
+        "  -n dBm         noise floor (default -130)\n"
+        "  -i file        bytes fed to the UART RX at 38400 baud\n"
+        "  -o file        UART TX output ('-' for stdout)\n"
+        "  -p             -i is a live pipe ('-' for stdin): feed what the client\n"
+        "                 writes, wait for it after 20 ms of UART silence, stop at EOF\n"
+        "  -L ms          client turnaround for -p (default 10)\n"
+        "  -l             print the LCD contents on exit\n"
+        "  -b name[:n]    run a benchmark after boot and exit (setup, regs, save)\n",
+        argv0);
+    exit(1);
+}
+
+// ---- benchmarks ----
+// Each one runs after boot, prints a summary line and ends the run.
+
+static void BenchSetupRegisters(unsigned int Count)
+{
+    // alternate between two VFOs that differ in frequency and bandwidth,
+    // the way dual watch or a scan hop does
+    gEeprom.VfoInfo[0].freq_config_RX.Frequency = 43350000;
+    gEeprom.VfoInfo[0].CHANNEL_BANDWIDTH        = BK4819_FILTER_BW_WIDE;
+    gEeprom.VfoInfo[1].freq_config_RX.Frequency = 14550000;
+    gEeprom.VfoInfo[1].CHANNEL_BANDWIDTH        = BK4819_FILTER_BW_NARROW;
+
+    const uint64_t Start   = gSimTimeUs;
+    const uint32_t Issued  = gBK4819_TransactionsIssued;
+    const uint32_t Elided  = gBK4819_TransactionsElided;
+
+    for (unsigned int i = 0; i < Count; i++) {
+        gRxVfo = &gEeprom.VfoInfo[i & 1];
+        RADIO_SetupRegisters(false);
+    }
+
+    printf("bench setup: %u calls, %.1f us/call, %.1f transfers/call, %.1f elided/call\n",
+        Count,
+        (double)(gSimTimeUs - Start) / Count,
+        (double)(gBK4819_TransactionsIssued - Issued) / Count,
+        (double)(gBK4819_TransactionsElided - Elided) / Count);
+}
+
+static void BenchRegisters(unsigned int Count)
+{
+    BK4819_Bench_t Bench;
+
+    BK4819_Benchmark(&Bench, Count);
+
+    // what the same transfers cost when every bus delay polled SysTick
+    const uint32_t PollWrite = Bench.WriteTicks + BK4819_WRITE_DELAYS * (Bench.PollTicks - Bench.SpinTicks);
+    const uint32_t PollRead  = Bench.ReadTicks  + BK4819_READ_DELAYS  * (Bench.PollTicks - Bench.SpinTicks);
+    const double   Mhz       = SYSTEM_CLOCK_MHZ;
+
+    printf("bench regs: %u calls, %u loops/us\n", Count, gSysTickSpinPerUs);
+    printf("  delay 1us: poll %.2f us, spin %.2f us\n",
+        Bench.PollTicks / Mhz / Count, Bench.SpinTicks / Mhz / Count);
+    printf("  write: %.1f us (%.0f/s), with polled delays %.1f us (%.0f/s)\n",
+        Bench.WriteTicks / Mhz / Count, Count * Mhz * 1e6 / Bench.WriteTicks,
+        PollWrite / Mhz / Count, Count * Mhz * 1e6 / PollWrite);
+    printf("  read:  %.1f us (%.0f/s), with polled delays %.1f us (%.0f/s)\n",
+        Bench.ReadTicks / Mhz / Count, Count * Mhz * 1e6 / Bench.ReadTicks,
+        PollRead / Mhz / Count, Count * Mhz * 1e6 / PollRead);
+}
+
+static void BenchSaveSettings(unsigned int Count)
+{
+    const uint64_t Start  = gSimTimeUs;
+    const uint32_t Cycles = gSimStats.eeprom_write_cycles;
+
+    for (unsigned int i = 0; i < Count; i++) {
+        // change a field in two different blocks so every save has work to do
+        gEeprom.SQUELCH_LEVEL = i % 10;
+        gEeprom.MIC_SENSITIVITY = i % 5;
+        SETTINGS_SaveSettings();
+    }
+
+    const uint64_t Saved = gSimTimeUs;
+
+    EEPROM_Flush();
+
+    printf("bench save: %u calls, %.1f us/call, %.1f write cycles/call, final flush %.1f us\n",
+        Count,
+        (double)(Saved - Start) / Count,
+        (double)(gSimStats.eeprom_write_cycles - Cycles) / Count,
+        (double)(gSimTimeUs - Saved));
+}
+
+static const struct {
+    const char *name;
+    void      (*run)(unsigned int Count);
+} Benches[] = {
+    {"setup", BenchSetupRegisters},
+    {"regs",  BenchRegisters},
+    {"save",  BenchSaveSettings},
+};
+
+static void RunBench(const char *spec)
+{
+    char         name[16] = {0};
+    unsigned int Count    = 100;
+
+    sscanf(spec, "%15[^:]:%u", name, &Count);
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(Benches); i++) {
+        if (strcmp(name, Benches[i].name) == 0) {
+            Benches[i].run(Count ? Count : 1);
+            SIM_Finish();
+        }
+    }
+
+    fprintf(stderr, "sim: unknown bench '%s'\n", name);
+    exit(1);
+}
+
+// A client talking to the sim through pipes. The sim runs far faster than
+// real time, so whenever it has sent something it gives the client 5 ms of
+// real time to answer, and whatever comes back only reaches the RX line -L
+// ms after what it answers, like through a USB serial adapter. Bytes the
+// client wrote earlier keep streaming. Once the firmware idles and the line
+// has been quiet for 20 ms, it runs at about real time, a tick per 10 ms,
+// so work the firmware spreads over ticks (a 0x0534 verify) still gets done.
+static void UartLiveRead(int Timeout)
+{
+    struct pollfd Poll = { .fd = fileno(pUartIn), .events = POLLIN };
+
+    while (UartLiveTail < sizeof(UartLiveBuf) && poll(&Poll, 1, Timeout) > 0) {
+        const ssize_t n = read(Poll.fd, UartLiveBuf + UartLiveTail, sizeof(UartLiveBuf) - UartLiveTail);
+
+        if (n <= 0) {
+            bUartLiveEof = true;
+            break;
+        }
+
+        UartLiveTail += n;
+        Timeout       = 0;
+    }
+}
+
+static void UartLive(void)
+{
+    if (gSimStats.uart_tx_bytes != UartTxSeen) {
+        UartTxSeen       = gSimStats.uart_tx_bytes;
+        UartLiveActiveUs = gSimTimeUs;
+        UartLiveSentUs   = gSimTimeUs;
+        bUartLiveOwed    = true;
+        fflush(gSimUartOut);
+    }
+
+    if (UartLiveHead == UartLiveTail) {
+        UartLiveHead = UartLiveTail = UartLiveHoldIndex = 0;
+
+        if (bUartLiveEof)
+            SIM_Finish();
+    }
+
+    if (!bUartLiveEof) {
+        const uint32_t Tail   = UartLiveTail;
+        const bool     bQuiet = UartLiveHead == UartLiveTail && gSimIdle &&
+                                gSimTimeUs - UartLiveActiveUs >= 20000;
+
+        UartLiveRead(bQuiet ? 10 : bUartLiveOwed ? 5 : 0);
+
+        if (!bQuiet && bUartLiveOwed && UartLiveTail != Tail) {
+            UartLiveHoldIndex = Tail;
+            UartLiveHoldUs    = UartLiveSentUs + UartLatencyUs;
+        }
+        if (UartLiveTail != Tail)
+            bUartLiveOwed = false;
+    }
+
+    // 38400 baud is ~38 bytes per 10 ms tick
+    for (unsigned int i = 0; i < 38 && UartLiveHead < UartLiveTail; i++) {
+        if (UartLiveHead >= UartLiveHoldIndex && gSimTimeUs < UartLiveHoldUs)
+            break;
+        if (!SIM_UART_Receive(UartLiveBuf[UartLiveHead]))
+            break;
+        UartLiveHead++;
+        UartLiveActiveUs = gSimTimeUs;
+    }
+}
+
+void SIM_Tick(void)
+{
+    if (gSimTimeUs >= gSimEndUs)
+        SIM_Finish();
+
+    if (KeyReleaseUs && gSimTimeUs >= KeyReleaseUs) {
+        SIM_KEYBOARD_Release();
+        KeyReleaseUs = 0;
+    }
+    if (KeyReleaseUs == 0 && KeyNext < KeyCount && gSimTimeUs >= Keys[KeyNext].at_ms * 1000ULL) {
+        SIM_KEYBOARD_Press(Keys[KeyNext].key);
+        KeyReleaseUs = gSimTimeUs + Keys[KeyNext].hold_ms * 1000ULL;
+        KeyNext++;
+    }
+
+    if (pUartIn && bUartLive)
+        UartLive();
+    else if (pUartIn) {
+        if (gSimStats.uart_tx_bytes != UartTxSeen) {
+            UartTxSeen      = gSimStats.uart_tx_bytes;
+            bUartAwaitReply = false;
+        }
+
+        // like a PC client, send one command and wait for the reply; give
+        // up after 100 ms, but only once the radio has booted and answered
+        if (bUartAwaitReply && (UartTxSeen == 0 || gSimTimeUs - UartSentUs < 100000))
+            return;
+        bUartAwaitReply = false;
+
+        // 38400 baud is ~38 bytes per 10 ms tick
+        for (unsigned int i = 0; i < 38; i++) {
+            const int c = fgetc(pUartIn);
+            if (c == EOF)
+                break;
+            if (!SIM_UART_Receive(c)) {
+                ungetc(c, pUartIn);
+                break;
+            }
+
+            if (UartFed == 0 && c != 0xAB)
+                continue;   // not framed, just stream it
+            if (UartFed < 4)
+                UartHeader[UartFed] = c;
+
+            // AB CD, size, size bytes, CRC, DC BA
+            if (++UartFed >= 4 && UartFed == 8u + (UartHeader[2] | UartHeader[3] << 8)) {
+                UartFed         = 0;
+                bUartAwaitReply = true;
+                UartSentUs      = gSimTimeUs;
+                break;
+            }
+        }
+    }
+}
+
+void SIM_SystemReset(void)
+{
+    fprintf(stderr, "sim: firmware requested a system reset\n");
+    SIM_Finish();
+}
+
+void SIM_Finish(void)
+{
+    gSimEndUs = UINT64_MAX;
+    SIM_UART_Flush();
+    if (gSimUartOut)
+        fflush(gSimUartOut);
+
+    if (bDumpLcd)
+        SIM_ST7565_Dump(stdout);
+    fflush(stdout);
+
+    if (bEepromWriteBack && EepromPath) {
+        FILE *f = fopen(EepromPath, "wb");
+        if (f) {
+            fwrite(gSimEEPROM, 1, sizeof(gSimEEPROM), f);
+            fclose(f);
+        }
+    }
+
+    const double seconds = gSimTimeUs / 1e6;
+    fprintf(stderr,
+        "sim: %.3f s virtual, %u ticks, %u main loops, %.1f%% idle\n"
+        "sim: bk4819   %u writes, %u reads (%u issued, %u elided)\n"
+        "sim: eeprom   %u transactions, %u bytes, %u write cycles (%u bytes), %u busy NACKs\n"
+        "sim: lcd      %u command bytes, %u data bytes\n"
+        "sim: uart     %u bytes out, %u bytes in, %u FIFO overruns, %u dropped from the queue\n"
+        "sim: delays   %llu us busy-waited\n",
+        seconds, gSimStats.ticks_10ms, gSimStats.main_loops,
+        gSimTimeUs ? 100.0 * gSimStats.idle_us / gSimTimeUs : 0.0,
+        gSimStats.bk4819_writes, gSimStats.bk4819_reads,
+        gBK4819_TransactionsIssued, gBK4819_TransactionsElided,
+        gSimStats.i2c_starts, gSimStats.i2c_bytes, gSimStats.eeprom_write_cycles,
+        gSimStats.eeprom_bytes_written, gSimStats.eeprom_nacks,
+        gSimStats.lcd_cmd_bytes, gSimStats.lcd_data_bytes,
+        gSimStats.uart_tx_bytes, gSimStats.uart_rx_bytes, gSimStats.uart_tx_overruns,
+#ifdef ENABLE_UART
+        gUART_TxOverflow,
+#else
+        0u,
+#endif
+        (unsigned long long)gSimStats.delay_us);
+#ifdef ENABLE_TICKLESS_IDLE
+    fprintf(stderr, "sim: tickless %u ticks slept through\n", gSysTickSkipped);
+#endif
+#ifdef ENABLE_PROFILER
+    {
+        static const char *Names[PROFILER_N_ELEM] = {
+            "APP_Update", "APP_TimeSlice10ms", "APP_TimeSlice500ms", "GUI_DisplayScreen",
+            "CheckRadioInterrupts", "AM_fix_10ms", "UART_HandleCommand"
+        };
+
+        fprintf(stderr, "sim: profiler load %u%%, %u missed slices\n",
+            PROFILER_LoadPercent(), (unsigned)gProfilerMissedSlices);
+        for (unsigned i = 0; i < PROFILER_N_ELEM; i++) {
+            const PROFILER_Stats_t *p = &gProfilerStats[i];
+
+            fprintf(stderr, "sim: profiler %-20s n=%-6u min=%uus mean=%uus max=%uus\n", Names[i],
+                (unsigned)p->Count, (unsigned)p->MinUs,
+                (unsigned)(p->Count ? p->TotalUs / p->Count : 0), (unsigned)p->MaxUs);
+        }
+    }
+#endif
+
+    exit(0);
+}
+
+static void Boot(void)
+{
+    // mirrors Main() without the welcome screen and boot-mode key checks
+    SYSCON_DEV_CLK_GATE = 0xFFFFFFFF;
+
+    TIMER_Arm(TIMER_BATTERY_SAVE, battery_save_count_10ms);
+
+    SYSTICK_Init();
+    BOARD_Init();
+
+#ifdef ENABLE_UART
+    UART_Init();
+#endif
+
+    memset(gDTMF_String, '-', sizeof(gDTMF_String));
+    gDTMF_String[sizeof(gDTMF_String) - 1] = 0;
+
+    BK4819_Init();
+
+    BOARD_ADC_GetBatteryInfo(&gBatteryCurrentVoltage, &gBatteryCurrent);
+
+    SETTINGS_InitEEPROM();
+
+#ifdef ENABLE_FEAT_F4HWN
+    gDW = gEeprom.DUAL_WATCH;
+    gCB = gEeprom.CROSS_BAND_RX_TX;
+#endif
+
+    SETTINGS_WriteBuildOptions();
+    SETTINGS_LoadCalibration();
+
+    RADIO_ConfigureChannel(0, VFO_CONFIGURE_RELOAD);
+    RADIO_ConfigureChannel(1, VFO_CONFIGURE_RELOAD);
+
+    RADIO_SelectVfos();
+
+    RADIO_SetupRegisters(true);
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(gBatteryVoltages); i++)
+        BOARD_ADC_GetBatteryInfo(&gBatteryVoltages[i], &gBatteryCurrent);
+
+    BATTERY_GetReadings(false);
+
+#ifdef ENABLE_AM_FIX
+    AM_fix_init();
+#endif
+
+    gMenuListCount = 0;
+    while (MenuList[gMenuListCount].name[0] != '\0') {
+        if (MenuList[gMenuListCount].menu_id == FIRST_HIDDEN_MENU_ITEM)
+            break;
+        gMenuListCount++;
+    }
+
+    BACKLIGHT_TurnOn();
+    BOOT_ProcessMode(BOOT_MODE_NORMAL);
+    gUpdateStatus = true;
+}
+
+int main(int argc, char *argv[])
+{
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:e:wk:c:n:i:o:pL:lb:")) != -1) {
+        switch (opt) {
+            case 't': gSimEndUs = strtoull(optarg, NULL, 0) * 1000; break;
+            case 'e': EepromPath = optarg; break;
+            case 'w': bEepromWriteBack = true; break;
+            case 'k': ParseKeys(optarg); break;
+            case 'c': ParseCarrier(optarg); break;
+            case 'n': gSimNoiseFloor_dBm = atoi(optarg); break;
+            case 'i':
+                pUartIn = strcmp(optarg, "-") == 0 ? stdin : fopen(optarg, "rb");
+                if (pUartIn == NULL) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'o':
+                gSimUartOut = strcmp(optarg, "-") == 0 ? stdout : fopen(optarg, "wb");
+                break;
+            case 'p': bUartLive = true; break;
+            case 'L': UartLatencyUs = strtoul(optarg, NULL, 0) * 1000; break;
+            case 'l': bDumpLcd = true; break;
+            case 'b': BenchSpec = optarg; break;
+            default:  Usage(argv[0]);
+        }
+    }
+
+    if (bUartLive && pUartIn)
+        fcntl(fileno(pUartIn), F_SETFL, fcntl(fileno(pUartIn), F_GETFL) | O_NONBLOCK);
+
+    MapPeripherals();
+    LoadEeprom();
+
+    Boot();
+
+    if (BenchSpec)
+        RunBench(BenchSpec);
+
+#ifdef ENABLE_PROFILER
+    PROFILER_Reset();
+#endif
+
+    while (true) {
+        gSimStats.main_loops++;
+
+        PROFILE(PROFILER_APP_UPDATE, APP_Update());
+
+        if (gNextTimeslice) {
+            PROFILE(PROFILER_TIMESLICE_10MS, APP_TimeSlice10ms());
+
+            if (gNextTimeslice_500ms)
+                PROFILE(PROFILER_TIMESLICE_500MS, APP_TimeSlice500ms());
+        }
+        else
+#ifdef ENABLE_TICKLESS_IDLE
+            APP_Idle();
+#else
+            SIM_Idle();
+#endif
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "driver/keyboard.h"
+
+// Virtual time in microseconds since power-on. It only moves when the
+// firmware waits (SYSTICK_DelayUs, SYSTEM_DelayMs), when a peripheral
+// model charges for bus time, or when the main loop has nothing to do.
+extern uint64_t gSimTimeUs;
+extern bool     gSimIdle;     // inside SIM_Idle(), the main loop has nothing to do
+extern uint64_t gSimEndUs;
+
+typedef struct {
+    uint32_t bk4819_writes;
+    uint32_t bk4819_reads;
+    uint32_t i2c_starts;
+    uint32_t i2c_bytes;
+    uint32_t eeprom_write_cycles;
+    uint32_t eeprom_bytes_written;
+    uint32_t eeprom_nacks;
+    uint32_t lcd_cmd_bytes;
+    uint32_t lcd_data_bytes;
+    uint32_t uart_tx_bytes;
+    uint32_t uart_tx_overruns;  // written to TDR while the FIFO was full
+    uint32_t uart_rx_bytes;
+    uint32_t ticks_10ms;
+    uint32_t main_loops;
+    uint64_t delay_us;
+    uint64_t idle_us;
+} SIM_Stats_t;
+
+extern SIM_Stats_t gSimStats;
+
+void SIM_Advance(uint32_t us);
+void SIM_Sample(void);
+void SIM_Idle(void);
+void SIM_Tick(void);
+__attribute__((noreturn)) void SIM_Finish(void);
+
+// BK4819 transceiver on GPIOC (3-wire SPI-ish, bit-banged by the firmware)
+typedef struct {
+    uint32_t frequency;     // 10 Hz units, same as the firmware
+    int16_t  dBm;
+} SIM_Carrier_t;
+
+#define SIM_MAX_CARRIERS 16
+
+extern uint16_t      gSimBK4819_Regs[128];
+extern SIM_Carrier_t gSimCarriers[SIM_MAX_CARRIERS];
+extern unsigned int  gSimCarrierCount;
+extern int16_t       gSimNoiseFloor_dBm;
+
+void SIM_BK4819_Sample(void);
+
+// I2C EEPROM on PA10/PA11
+#define SIM_EEPROM_SIZE      0x2000
+#define SIM_EEPROM_PAGE_SIZE 32
+
+extern uint8_t  gSimEEPROM[SIM_EEPROM_SIZE];
+extern uint32_t gSimEEPROM_WriteTimeUs;
+
+void SIM_EEPROM_Init(void);
+void SIM_EEPROM_Sample(void);
+
+// ST7565 panel behind SPI0
+void SIM_ST7565_Write(uint8_t Value, bool bData);
+void SIM_ST7565_Dump(FILE *pFile);
+
+// Keypad matrix and PTT
+void SIM_KEYBOARD_Press(KEY_Code_t Key);
+void SIM_KEYBOARD_Release(void);
+void SIM_KEYBOARD_Sample(void);
+
+// UART1
+extern FILE *gSimUartOut;
+
+void SIM_UART_Flush(void);
+void SIM_UART_Run(void);
+// when the TX FIFO interrupt is next due, UINT64_MAX if it is off
+uint64_t SIM_UART_NextUs(void);
+bool SIM_UART_Receive(uint8_t Byte);
+
+#endif
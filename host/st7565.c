@@ -0,0 +1,69 @@
+#include <string.h>
+
+#include "bsp/dp32g030/gpio.h"
+#include "bsp/dp32g030/spi.h"
+#include "driver/gpio.h"
+#include "host/sim.h"
+
+// ST7565 panel: 8 pages of 132 columns, addressed with the page/column
+// commands the driver sends before every line. A0 (PB9) selects data.
+
+#define SPI_IDLE 0xFFFFFFFFU
+
+static volatile SPI_Port_t gSimSPI0 = { .WDR = SPI_IDLE };
+
+static uint8_t  Ram[8][132];
+static uint8_t  Page;
+static uint8_t  Column;
+static bool     bParameter;
+static uint32_t SpiNs;
+
+volatile SPI_Port_t *SIM_SPI0(void)
+{
+    if (gSimSPI0.WDR != SPI_IDLE) {
+        SIM_ST7565_Write(gSimSPI0.WDR, GPIO_CheckBit(&GPIOB->DATA, GPIOB_PIN_ST7565_A0));
+        gSimSPI0.WDR = SPI_IDLE;
+    }
+    gSimSPI0.IF     = 0;
+    gSimSPI0.FIFOST = 0;
+    return &gSimSPI0;
+}
+
+void SIM_ST7565_Write(uint8_t Value, bool bData)
+{
+    // SPR = 2 gives a 6 MHz SCK, so 8 bits take ~1.33 us
+    SpiNs += 1333;
+    if (SpiNs >= 1000) {
+        SIM_Advance(SpiNs / 1000);
+        SpiNs %= 1000;
+    }
+
+    if (bData) {
+        gSimStats.lcd_data_bytes++;
+        if (Page < 8 && Column < 132)
+            Ram[Page][Column++] = Value;
+        return;
+    }
+
+    gSimStats.lcd_cmd_bytes++;
+
+    if (bParameter)                         // contrast value after 0x81
+        bParameter = false;
+    else if (Value == 0x81)
+        bParameter = true;
+    else if ((Value & 0xF0) == 0xB0)
+        Page = Value & 0x0F;
+    else if ((Value & 0xF0) == 0x10)
+        Column = (Column & 0x0F) | ((Value & 0x0F) << 4);
+    else if ((Value & 0xF0) == 0x00)
+        Column = (Column & 0xF0) | (Value & 0x0F);
+}
+
+void SIM_ST7565_Dump(FILE *pFile)
+{
+    for (unsigned int y = 0; y < 64; y++) {
+        for (unsigned int x = 0; x < 128; x++)
+            fputc((Ram[y / 8][x + 4] >> (y % 8)) & 1u ? '#' : '.', pFile);
+        fputc('\n', pFile);
+    }
+}
@@ -0,0 +1,155 @@
+#include "ARMCM0.h"
+#include "driver/system.h"
+#include "driver/systick.h"
+#include "host/sim.h"
+#include "misc.h"
+
+// Host replacement for driver/systick.c. Delays do not burn wall-clock
+// time; they move the virtual clock forward, let the pin-level models look
+// at the GPIOs and fire SystickHandler() for every 10 ms boundary crossed,
+// just as the SysTick interrupt would preempt a busy-wait on the radio.
+
+SysTick_Type gSimSysTick;
+uint64_t     gSimTimeUs;
+bool         gSimIdle;
+uint8_t      gSysTickSpinPerUs;
+
+static uint64_t TickDueUs = 10000;
+
+#ifdef ENABLE_TICKLESS_IDLE
+    uint32_t gSysTickSkipped;
+
+    static uint8_t  SleepTicks;
+    static uint64_t IdleUs;
+    static uint32_t WindowTicks;
+#endif
+
+void SystickHandler(void);
+
+void SYSTICK_Init(void)
+{
+    gSimSysTick.LOAD = 480000 - 1;
+    gSimSysTick.VAL  = gSimSysTick.LOAD;
+    gSimSysTick.CTRL = 7;
+
+    // what SYSTICK_Init() measures on a radio running from flash
+    gSysTickSpinPerUs = SYSTEM_CLOCK_MHZ / 4;
+}
+
+void SYSTICK_DelayUs(uint32_t Delay)
+{
+    SIM_Sample();
+    gSimStats.delay_us += Delay;
+    SIM_Advance(Delay);
+}
+
+void SYSTICK_Spin(uint32_t Loops)
+{
+    static uint32_t Fraction;   // sub-microsecond remainder, in loops
+
+    SIM_Sample();
+
+    Fraction += Loops;
+
+    const uint32_t us = Fraction / gSysTickSpinPerUs;
+
+    Fraction %= gSysTickSpinPerUs;
+    gSimStats.delay_us += us;
+    SIM_Advance(us);
+}
+
+void SIM_Advance(uint32_t us)
+{
+    const uint64_t end = gSimTimeUs + us;
+
+    while (true) {
+        const uint64_t next = TickDueUs;
+        const uint64_t uart = SIM_UART_NextUs();
+
+        // the TX FIFO interrupt keeps the line busy while the CPU waits
+        if (uart < next && uart <= end) {
+            if (uart > gSimTimeUs)
+                gSimTimeUs = uart;
+            SIM_UART_Run();
+            if (SIM_UART_NextUs() > gSimTimeUs)
+                continue;
+        }
+
+        if (next > end)
+            break;
+        gSimTimeUs = next;
+        TickDueUs  = next + 10000;
+        gSimStats.ticks_10ms++;
+        SIM_Tick();
+        SystickHandler();
+    }
+
+    gSimTimeUs = end;
+    SIM_UART_Run();
+
+    // SysTick counts down to the next interrupt at 48 MHz
+    gSimSysTick.VAL = (uint32_t)(TickDueUs - gSimTimeUs) * 48 - 1;
+}
+
+void SIM_Idle(void)
+{
+    const uint32_t us = TickDueUs - gSimTimeUs;
+
+    gSimStats.idle_us += us;
+    gSimIdle = true;
+    SIM_Advance(us);
+    gSimIdle = false;
+}
+
+void SIM_Sample(void)
+{
+    SIM_KEYBOARD_Sample();
+    SIM_BK4819_Sample();
+    SIM_EEPROM_Sample();
+}
+
+#ifdef ENABLE_TICKLESS_IDLE
+// same contract as driver/systick.c, WFI sleeps until the SysTick interrupt
+void SYSTICK_Sleep(uint32_t Ticks)
+{
+    if (Ticks > 1 && TickDueUs - gSimTimeUs > 1000) {
+        TickDueUs  += (Ticks - 1) * 10000ULL;
+        SleepTicks  = Ticks;
+    }
+
+    IdleUs += TickDueUs - gSimTimeUs;
+    SIM_Idle();
+}
+
+uint32_t SYSTICK_Wake(void)
+{
+    uint32_t Ticks = 1;
+
+    if (SleepTicks) {
+        Ticks            = SleepTicks;
+        SleepTicks       = 0;
+        gSysTickSkipped += Ticks - 1;
+    }
+
+    WindowTicks += Ticks;
+
+    return Ticks;
+}
+
+uint8_t SYSTICK_IdlePercent(void)
+{
+    const uint8_t Percent = WindowTicks ? MIN(IdleUs / (WindowTicks * 100ULL), 100u) : 0;
+
+    IdleUs      = 0;
+    WindowTicks = 0;
+
+    return Percent;
+}
+#endif
+
+#ifdef ENABLE_PROFILER
+uint32_t SYSTICK_GetUs(void)
+{
+    return gSimTimeUs;
+}
+#endif
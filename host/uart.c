@@ -0,0 +1,99 @@
+#include "bsp/dp32g030/dma.h"
+#include "bsp/dp32g030/uart.h"
+#include "driver/uart.h"
+#include "host/sim.h"
+
+// UART1 at 38400 8N1 with an 8-byte TX FIFO that empties one byte every
+// 260 us of virtual time, raising the TX FIFO interrupt once it is down to
+// 4 bytes. RX bytes land in UART_DMA_Buffer the way the DMA channel set up
+// by UART_Init() would put them there. Without ENABLE_UART the firmware has
+// neither the handler nor the buffer, so the port only ever sees TX.
+
+#define UART_IDLE      0xFFFFFFFFU
+#define UART_BYTE_US   260
+#define UART_FIFO_SIZE 8
+
+static volatile UART_Port_t gSimUART1 = { .TDR = UART_IDLE };
+
+static uint32_t TxCount;    // bytes in the FIFO and the shift register
+static uint64_t TxNextUs;   // when the oldest of them is out
+
+FILE *gSimUartOut;
+
+volatile UART_Port_t *SIM_UART1(void)
+{
+    SIM_UART_Flush();
+    gSimUART1.IF = 0
+        | (TxCount >= UART_FIFO_SIZE ? UART_IF_TXFIFO_FULL_BITS_SET : 0)
+        | (TxCount <= 4 ? UART_IF_TXFIFO_BITS_SET : 0);
+    return &gSimUART1;
+}
+
+void SIM_UART_Flush(void)
+{
+    if (gSimUART1.TDR == UART_IDLE)
+        return;
+
+    // the byte is on the wire as far as the host is concerned
+    if (gSimUartOut)
+        fputc(gSimUART1.TDR & 0xFF, gSimUartOut);
+    gSimUART1.TDR = UART_IDLE;
+    gSimStats.uart_tx_bytes++;
+
+    if (TxCount >= UART_FIFO_SIZE)
+        gSimStats.uart_tx_overruns++;
+    else if (TxCount++ == 0)
+        TxNextUs = gSimTimeUs + UART_BYTE_US;
+}
+
+void SIM_UART_Run(void)
+{
+#ifdef ENABLE_UART
+    static bool bBusy;
+
+    void HandlerUART1(void);
+#endif
+
+    while (TxCount > 0 && gSimTimeUs >= TxNextUs) {
+        TxCount--;
+        TxNextUs += UART_BYTE_US;
+    }
+
+#ifdef ENABLE_UART
+    if (bBusy || !(gSimUART1.IE & UART_IE_TXFIFO_MASK) || TxCount > 4)
+        return;
+
+    bBusy = true;
+    HandlerUART1();
+    bBusy = false;
+#endif
+}
+
+uint64_t SIM_UART_NextUs(void)
+{
+    if (!(gSimUART1.IE & UART_IE_TXFIFO_MASK))
+        return UINT64_MAX;
+
+    if (TxCount <= 4)
+        return gSimTimeUs;
+
+    return TxNextUs + (uint64_t)(TxCount - 5) * UART_BYTE_US;
+}
+
+bool SIM_UART_Receive(uint8_t Byte)
+{
+#ifndef ENABLE_UART
+    (void)Byte;
+    return false;
+#else
+    const uint32_t Index = DMA_CH0->ST & 0xFFFU;
+
+    if ((gSimUART1.CTRL & UART_CTRL_RXDMAEN_MASK) == 0)
+        return false;
+
+    UART_DMA_Buffer[Index] = Byte;
+    DMA_CH0->ST = (DMA_CH0->ST & ~0xFFFU) | ((Index + 1) % sizeof(UART_DMA_Buffer));
+    gSimStats.uart_rx_bytes++;
+    return true;
+#endif
+}
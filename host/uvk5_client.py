@@ -0,0 +1,398 @@
+#!/usr/bin/env python3
+# EEPROM client for the UART protocol, legacy 0x051B/0x051D and the
+# ENABLE_UART_BULK commands, against a radio or the host simulator.
+#
+#   uvk5_client.py --port /dev/ttyUSB0 read codeplug.bin
+#   uvk5_client.py --port /dev/ttyUSB0 write codeplug.bin
+#   uvk5_client.py --sim host/build/uvk5-sim --eeprom img.bin bench
+#   uvk5_client.py --port /dev/ttyUSB0 mirror [screen.pbm]
+#   uvk5_client.py --port /dev/ttyUSB0 idle
+#   uvk5_client.py --port /dev/ttyUSB0 profile [--reset]
+#
+# Bulk read (0x0530) streams 0x0531 windows, each with its own CRC; a bad
+# window is simply asked for again. Bulk write sends 0x0532 chunks without
+# waiting for each ack (0x0533) and checks every window with 0x0534, which
+# reads it back on the radio a piece a tick and compares CRCs (0x0535).
+#
+# mirror turns on the screen mirror (0x0609, ENABLE_FEAT_F4HWN_SCREENSHOT)
+# and shows the radio's screen as its pages change, see screenshot.h.
+#
+# idle polls 0x060A (ENABLE_TICKLESS_IDLE) once a second for the share of
+# time the CPU sleeps and the SysTick interrupts it skipped.
+#
+# profile dumps the main loop timings (0x060C, ENABLE_PROFILER), see
+# app/profiler.h, and with --reset starts them over.
+
+import argparse
+import re
+import struct
+import subprocess
+import sys
+import time
+
+OBFUSCATION = bytes([0x16, 0x6C, 0x14, 0xE6, 0x2E, 0x91, 0x0D, 0x40,
+                     0x21, 0x35, 0xD5, 0x40, 0x13, 0x03, 0xE9, 0x80])
+EEPROM_SIZE = 0x2000
+TIMESTAMP   = 0x6B5A4C3D
+
+
+def crc16(data, crc=0):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def xor(data, obfuscate):
+    if not obfuscate:
+        return bytes(data)
+    return bytes(b ^ OBFUSCATION[i % 16] for i, b in enumerate(data))
+
+
+class SerialLink:
+    def __init__(self, port):
+        import serial
+        self.port = serial.Serial(port, 38400, timeout=0.05)
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self):
+        return self.port.read(4096)
+
+    def close(self):
+        self.port.close()
+        return None
+
+
+class SimLink:
+    # the simulator in live pipe mode (-p), its virtual time is the clock
+    def __init__(self, sim, eeprom, write_back=False):
+        args = [sim, '-p', '-i', '-', '-o', '-', '-t', '3600000', '-e', eeprom]
+        if write_back:
+            args.append('-w')
+        self.proc = subprocess.Popen(args, stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                     stderr=subprocess.PIPE, bufsize=0)
+        import os
+        os.set_blocking(self.proc.stdout.fileno(), False)
+
+    def write(self, data):
+        self.proc.stdin.write(data)
+        self.proc.stdin.flush()
+
+    def read(self):
+        data = self.proc.stdout.read(4096)
+        if not data:
+            time.sleep(0.0005)
+        return data or b''
+
+    def close(self):
+        self.proc.stdin.close()
+        err = self.proc.stderr.read().decode()
+        self.proc.wait()
+        m = re.search(r'sim: ([0-9.]+) s virtual', err)
+        return float(m.group(1)) if m else None
+
+
+class Radio:
+    def __init__(self, link, obfuscate=False):
+        self.link = link
+        # a plain 0x0514 turns obfuscation off for the session
+        self.obfuscate = obfuscate
+        self.rx = b''
+
+    def send(self, cmd, payload):
+        body = struct.pack('<HH', cmd, len(payload)) + payload
+        body += struct.pack('<H', crc16(body))
+        self.link.write(b'\xAB\xCD' + struct.pack('<H', len(body) - 2) +
+                        xor(body, self.obfuscate) + b'\xDC\xBA')
+
+    def receive(self, timeout=5.0):
+        end = time.time() + timeout
+        while True:
+            i = self.rx.find(b'\xAB\xCD')
+            if i >= 0 and len(self.rx) >= i + 4:
+                size = struct.unpack('<H', self.rx[i + 2:i + 4])[0]
+                if len(self.rx) >= i + 4 + size + 4:
+                    body = xor(self.rx[i + 4:i + 4 + size], self.obfuscate)
+                    self.rx = self.rx[i + 4 + size + 4:]
+                    cmd, = struct.unpack('<H', body[:2])
+                    return cmd, body[4:]
+            if time.time() > end:
+                raise TimeoutError('no reply from the radio')
+            self.rx += self.link.read()
+
+    def expect(self, cmd):
+        while True:
+            got, data = self.receive()
+            if got == cmd:
+                return data
+
+    def hello(self):
+        body = struct.pack('<HHI', 0x0514, 4, TIMESTAMP)
+        body += struct.pack('<H', crc16(body))
+        self.link.write(b'\xAB\xCD' + struct.pack('<H', len(body) - 2) + body + b'\xDC\xBA')
+        return self.expect(0x0515)
+
+    # ---- legacy, what CHIRP does ----
+
+    def legacy_read(self, offset, size):
+        out = b''
+        while len(out) < size:
+            n = min(128, size - len(out))
+            self.send(0x051B, struct.pack('<HBBI', offset + len(out), n, 0, TIMESTAMP))
+            data = self.expect(0x051C)
+            out += data[4:4 + n]
+        return out
+
+    def legacy_write(self, offset, data):
+        for i in range(0, len(data), 128):
+            chunk = data[i:i + 128]
+            self.send(0x051D, struct.pack('<HBBI', offset + i, len(chunk), 0, TIMESTAMP) + chunk)
+            self.expect(0x051E)
+
+    # ---- bulk ----
+
+    def bulk_read(self, offset, size, window=2048):
+        out = bytearray(size)
+        todo = [(offset, size)]
+        while todo:
+            start, length = todo.pop(0)
+            self.send(0x0530, struct.pack('<HHHHI', start, length, window, 0, TIMESTAMP))
+            done = start
+            while done < start + length:
+                data = self.expect(0x0531)
+                off, n = struct.unpack('<HH', data[:4])
+                payload = data[4:4 + n]
+                crc, = struct.unpack('<H', data[4 + n:6 + n])
+                if crc16(payload) == crc:
+                    out[off - offset:off - offset + n] = payload
+                else:
+                    todo.append((off, n))
+                done = off + n
+        return bytes(out)
+
+    def bulk_write(self, offset, data, chunk=192, window=2048, in_flight=2, attempts=3):
+        # (kind, offset, size) of everything sent and not answered yet
+        pending = []
+        retry = []
+
+        def collect():
+            # the radio answers a verify a few ticks later, writes after it
+            # can be acked first
+            cmd, reply = self.receive()
+            kind = {0x0533: 'write', 0x0535: 'verify'}.get(cmd)
+            if kind is None:
+                raise RuntimeError('unexpected reply %04X' % cmd)
+            _, off, size = pending.pop([p[0] for p in pending].index(kind))
+            if kind == 'verify' and not reply[6]:
+                retry.append((off, size))
+
+        windows = [(o, min(window, len(data) - o)) for o in range(0, len(data), window)]
+        for _ in range(attempts):
+            if not windows:
+                return
+            for start, length in windows:
+                for i in range(start, start + length, chunk):
+                    n = min(chunk, start + length - i)
+                    while len(pending) >= in_flight:
+                        collect()
+                    self.send(0x0532, struct.pack('<HBBI', offset + i, n, 0, TIMESTAMP) + data[i:i + n])
+                    pending.append(('write', offset + i, n))
+                # it takes one verify at a time
+                while len(pending) >= in_flight or any(p[0] == 'verify' for p in pending):
+                    collect()
+                self.send(0x0534, struct.pack('<HHHHI', offset + start, length,
+                                              crc16(data[start:start + length]), 0, TIMESTAMP))
+                pending.append(('verify', start, length))
+            while pending:
+                collect()
+            windows, retry[:] = list(retry), []
+        # e.g. the journal ring at 0x1D00, which the radio keeps to itself
+        raise RuntimeError('verify failed at ' + ', '.join('%04X' % (offset + o) for o, _ in windows))
+
+
+class Screen:
+    # 0xAA 0x55 0x01 frames: size, page mask and PackBits pages
+    def __init__(self):
+        self.pages = [bytearray(128) for _ in range(8)]
+        self.rx = b''
+
+    @staticmethod
+    def unpack(data, pos):
+        out = bytearray()
+        while len(out) < 128:
+            n = data[pos]
+            pos += 1
+            if n < 128:
+                out += data[pos:pos + n + 1]
+                pos += n + 1
+            elif n > 128:
+                out += bytes([data[pos]]) * (257 - n)
+                pos += 1
+        return out, pos
+
+    def feed(self, data):
+        # returns the mask of pages that were updated
+        self.rx += data
+        updated = 0
+        while True:
+            i = self.rx.find(b'\xAA\x55\x01')
+            if i < 0 or len(self.rx) < i + 5:
+                return updated
+            size, = struct.unpack('<H', self.rx[i + 3:i + 5])
+            if len(self.rx) < i + 5 + size:
+                return updated
+            body = self.rx[i + 5:i + 5 + size]
+            self.rx = self.rx[i + 5 + size:]
+            mask, pos = body[0], 1
+            for page in range(8):
+                if mask & (1 << page):
+                    self.pages[page], pos = self.unpack(body, pos)
+            updated |= mask
+
+    def pixel(self, x, y):
+        return (self.pages[y // 8][x] >> (y % 8)) & 1
+
+    def text(self):
+        return ''.join(''.join('#' if self.pixel(x, y) else '.' for x in range(128)) + '\n'
+                       for y in range(64))
+
+    def pbm(self):
+        return ('P1\n128 64\n' + ''.join(' '.join(str(self.pixel(x, y)) for x in range(128)) + '\n'
+                                        for y in range(64))).encode()
+
+
+def run_mirror(radio, link, path):
+    screen = Screen()
+    radio.send(0x0609, bytes([1, 0, 0, 0]))
+    try:
+        while True:
+            data = link.read()
+            if not data:
+                continue
+            if not screen.feed(data):
+                continue
+            if path:
+                with open(path, 'wb') as f:
+                    f.write(screen.pbm())
+            else:
+                sys.stdout.write('\x1b[H' + screen.text())
+                sys.stdout.flush()
+    except KeyboardInterrupt:
+        radio.send(0x0609, bytes([0, 0, 0, 0]))
+
+
+def run_idle(radio):
+    try:
+        while True:
+            radio.send(0x060A, b'')
+            percent, ticks, skipped = struct.unpack('<B3xII', radio.expect(0x060B)[:12])
+            print('%3d%% idle  %8.2f s up  %d ticks slept through' % (percent, ticks / 100, skipped))
+            time.sleep(1)
+    except KeyboardInterrupt:
+        pass
+
+
+PROFILER_NAMES = ['APP_Update', 'APP_TimeSlice10ms', 'APP_TimeSlice500ms',
+                  'GUI_DisplayScreen', 'CheckRadioInterrupts', 'AM_fix_10ms',
+                  'UART_HandleCommand']
+
+
+def run_profile(radio, reset):
+    radio.send(0x060C, bytes([1 if reset else 0, 0, 0, 0]))
+    data = radio.expect(0x060D)
+    elapsed, missed, load = struct.unpack('<IIB3x', data[:12])
+    print('%.2f s  %d%% load  %d missed 10 ms slices' % (elapsed / 1e6, load, missed))
+    print('%-20s %8s %8s %8s %8s' % ('', 'calls', 'min us', 'mean us', 'max us'))
+    for i, name in enumerate(PROFILER_NAMES):
+        count, lo, mean, hi = struct.unpack_from('<IIII', data, 12 + 16 * i)
+        print('%-20s %8d %8d %8d %8d' % (name, count, lo, mean, hi))
+
+
+def run_bench(args):
+    def session(work):
+        link = SimLink(args.sim, args.eeprom)
+        radio = Radio(link)
+        radio.hello()
+        result = work(radio)
+        return link.close(), result
+
+    # what the radio makes of the image, journal applied, so writing it
+    # back is a plain restore
+    _, image = session(lambda r: r.bulk_read(0, EEPROM_SIZE))
+    # leave the calibration area alone
+    size = 0x1E00
+
+    base, _ = session(lambda r: None)
+    rows = [
+        ('legacy read',  lambda r: r.legacy_read(0, EEPROM_SIZE), EEPROM_SIZE),
+        ('bulk read',    lambda r: r.bulk_read(0, EEPROM_SIZE),   EEPROM_SIZE),
+        ('legacy write', lambda r: r.legacy_write(0, image[:size]), size),
+        ('bulk write',   lambda r: r.bulk_write(0, image[:size]),   size),
+    ]
+    for name, work, nbytes in rows:
+        seconds, result = session(work)
+        if result is not None and result != image[:nbytes]:
+            print('%-12s  data mismatch' % name)
+            continue
+        t = seconds - base
+        print('%-12s  %5d bytes  %6.2f s  %5.0f B/s' % (name, nbytes, t, nbytes / t))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument('--port', help='serial port of the radio')
+    ap.add_argument('--sim', help='host/build/uvk5-sim built with ENABLE_UART_BULK=1')
+    ap.add_argument('--eeprom', help='EEPROM image the simulator starts from')
+    ap.add_argument('--legacy', action='store_true', help='use 0x051B/0x051D only')
+    ap.add_argument('--window', type=int, default=2048)
+    ap.add_argument('--reset', action='store_true', help='profile: clear the timings after the dump')
+    ap.add_argument('command', choices=['read', 'write', 'bench', 'mirror', 'idle', 'profile'])
+    ap.add_argument('file', nargs='?')
+    args = ap.parse_args()
+
+    if args.command == 'bench':
+        if not args.sim or not args.eeprom:
+            ap.error('bench needs --sim and --eeprom')
+        run_bench(args)
+        return
+
+    if args.port:
+        link = SerialLink(args.port)
+    elif args.sim and args.eeprom:
+        link = SimLink(args.sim, args.eeprom, write_back=args.command == 'write')
+    else:
+        ap.error('need --port, or --sim and --eeprom')
+
+    radio = Radio(link)
+    version = radio.hello()
+    print('radio: %s' % version[:16].split(b'\0')[0].decode(errors='replace'), file=sys.stderr)
+
+    if args.command == 'mirror':
+        run_mirror(radio, link, args.file)
+    elif args.command == 'idle':
+        run_idle(radio)
+    elif args.command == 'profile':
+        run_profile(radio, args.reset)
+    elif args.command == 'read':
+        if args.legacy:
+            data = radio.legacy_read(0, EEPROM_SIZE)
+        else:
+            data = radio.bulk_read(0, EEPROM_SIZE, args.window)
+        with open(args.file, 'wb') as f:
+            f.write(data)
+    else:
+        with open(args.file, 'rb') as f:
+            data = f.read()[:0x1E00]
+        if args.legacy:
+            radio.legacy_write(0, data)
+        else:
+            radio.bulk_write(0, data, window=args.window)
+
+    link.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -26,6 +26,7 @@
 #include "board.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "version.h"
 
@@ -42,6 +43,7 @@
 
 #include "app/app.h"
 #include "app/dtmf.h"
+#include "app/profiler.h"
 #include "bsp/dp32g030/gpio.h"
 #include "bsp/dp32g030/syscon.h"
 
@@ -85,6 +87,9 @@ void Main(void)
         | SYSCON_DEV_CLK_GATE_PWM_PLUS0_BITS_ENABLE;
 
 
+    // the battery save countdown runs from power-on
+    TIMER_Arm(TIMER_BATTERY_SAVE, battery_save_count_10ms);
+
     SYSTICK_Init();
     BOARD_Init();
 
@@ -364,16 +369,24 @@ void Main(void)
         #endif
     #endif
         
+#ifdef ENABLE_PROFILER
+    PROFILER_Reset();
+#endif
+
     while (true) {
-        APP_Update();
+        PROFILE(PROFILER_APP_UPDATE, APP_Update());
 
         if (gNextTimeslice) {
 
-            APP_TimeSlice10ms();
+            PROFILE(PROFILER_TIMESLICE_10MS, APP_TimeSlice10ms());
 
             if (gNextTimeslice_500ms) {
-                APP_TimeSlice500ms();
+                PROFILE(PROFILER_TIMESLICE_500MS, APP_TimeSlice500ms());
             }
         }
+#ifdef ENABLE_TICKLESS_IDLE
+        else
+            APP_Idle();
+#endif
     }
 }
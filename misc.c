@@ -166,14 +166,11 @@ uint16_t          gEEPROM_1F8C;
 ChannelAttributes_t gMR_ChannelAttributes[FREQ_CHANNEL_LAST + 1];
 bool                gMR_ChannelExclude[FREQ_CHANNEL_LAST + 1];
 
-volatile uint16_t gBatterySaveCountdown_10ms = battery_save_count_10ms;
-
 volatile bool     gPowerSaveCountdownExpired;
 volatile bool     gSchedulePowerSave;
 
 volatile bool     gScheduleDualWatch = true;
 
-volatile uint16_t gDualWatchCountdown_10ms;
 bool              gDualWatchActive           = false;
 
 volatile uint8_t  gSerialConfigCountDown_500ms;
@@ -196,10 +193,6 @@ volatile uint16_t gTailNoteEliminationCountdown_10ms;
 
 volatile uint8_t    gVFOStateResumeCountdown_500ms;
 
-#ifdef ENABLE_NOAA
-    volatile uint16_t gNOAA_Countdown_10ms;
-#endif
-
 bool              gEnableSpeaker;
 uint8_t           gKeyInputCountdown = 0;
 uint8_t           gKeyLockCountdown;
@@ -218,7 +211,6 @@ uint8_t           gBatteryVoltageIndex;
 bool              gCssBackgroundScan;
 
 volatile bool     gScheduleScanListen = true;
-volatile uint16_t gScanPauseDelayIn_10ms;
 
 #if defined(ENABLE_ALARM) || defined(ENABLE_TX1750)
     AlarmState_t  gAlarmState;
@@ -287,14 +279,11 @@ bool              gF_LOCK = false;
 uint8_t           gShowChPrefix;
 
 volatile bool     gNextTimeslice;
-volatile uint8_t  gFoundCDCSSCountdown_10ms;
-volatile uint8_t  gFoundCTCSSCountdown_10ms;
-#ifdef ENABLE_VOX
-    volatile uint16_t gVoxStopCountdown_10ms;
+#ifdef ENABLE_TICKLESS_IDLE
+    uint8_t       gIdlePercent;
 #endif
 volatile bool     gNextTimeslice40ms;
 #ifdef ENABLE_NOAA
-    volatile uint16_t gNOAACountdown_10ms = 0;
     volatile bool     gScheduleNOAA       = true;
 #endif
 volatile bool     gFlagTailNoteEliminationComplete;
@@ -36,6 +36,13 @@
     #define SWAP(a, b) ({ __typeof__ (a) _c = (a);  a = b; b = _c; })
 #endif
 
+// code copied to SRAM at boot, out of reach of the flash wait states
+#if defined(ENABLE_RAMFUNC) && defined(__arm__)
+    #define RAMFUNC __attribute__((section(".ramfunc")))
+#else
+    #define RAMFUNC
+#endif
+
 #define IS_MR_CHANNEL(x)       ((x) <= MR_CHANNEL_LAST)
 #define IS_FREQ_CHANNEL(x)     ((x) >= FREQ_CHANNEL_FIRST && (x) <= FREQ_CHANNEL_LAST)
 #define IS_VALID_CHANNEL(x)    ((x) < LAST_CHANNEL)
@@ -232,14 +239,11 @@ typedef union {
 extern ChannelAttributes_t   gMR_ChannelAttributes[207];
 extern bool                  gMR_ChannelExclude[207];
 
-extern volatile uint16_t     gBatterySaveCountdown_10ms;
-
 extern volatile bool         gPowerSaveCountdownExpired;
 extern volatile bool         gSchedulePowerSave;
 
 extern volatile bool         gScheduleDualWatch;
 
-extern volatile uint16_t     gDualWatchCountdown_10ms;
 extern bool                  gDualWatchActive;
 
 extern volatile uint8_t      gSerialConfigCountDown_500ms;
@@ -260,9 +264,6 @@ extern volatile bool         gTxTimeoutReached;
 
 extern volatile uint16_t     gTailNoteEliminationCountdown_10ms;
 
-#ifdef ENABLE_NOAA
-    extern volatile uint16_t gNOAA_Countdown_10ms;
-#endif
 extern bool                  gEnableSpeaker;
 extern uint8_t               gKeyInputCountdown;
 extern uint8_t               gKeyLockCountdown;
@@ -292,7 +293,6 @@ enum
 };
 
 extern volatile bool     gScheduleScanListen;
-extern volatile uint16_t gScanPauseDelayIn_10ms;
 
 extern AlarmState_t          gAlarmState;
 extern uint16_t              gMenuCountdown;
@@ -352,20 +352,21 @@ extern uint8_t               gFSKWriteIndex;
     extern uint8_t           gNoaaChannel;
 #endif
 extern volatile bool         gNextTimeslice;
+extern volatile uint32_t     gGlobalSysTickCounter;
+#ifdef ENABLE_TICKLESS_IDLE
+    // 10 ms ticks until the nearest running counter in scheduler.c ends,
+    // see also TIMER_NextDeadline()
+    extern volatile uint8_t  gSchedulerSlack_10ms;
+    extern uint8_t           gIdlePercent;
+#endif
 extern bool                  gUpdateDisplay;
 extern bool                  gF_LOCK;
 #ifdef ENABLE_FMRADIO
     extern uint8_t           gFM_ChannelPosition;
 #endif
 extern uint8_t               gShowChPrefix;
-extern volatile uint8_t      gFoundCDCSSCountdown_10ms;
-extern volatile uint8_t      gFoundCTCSSCountdown_10ms;
-#ifdef ENABLE_VOX
-    extern volatile uint16_t gVoxStopCountdown_10ms;
-#endif
 extern volatile bool         gNextTimeslice40ms;
 #ifdef ENABLE_NOAA
-    extern volatile uint16_t gNOAACountdown_10ms;
     extern volatile bool     gScheduleNOAA;
 #endif
 extern volatile bool         gFlagTailNoteEliminationComplete;
@@ -34,6 +34,7 @@
 #include "helper/battery.h"
 #include "misc.h"
 #include "radio.h"
+#include "scheduler.h"
 #include "settings.h"
 #include "ui/menu.h"
 
@@ -43,6 +44,32 @@ VFO_Info_t    *gCurrentVfo;
 DCS_CodeType_t gCurrentCodeType;
 VfoState_t     VfoState[2];
 
+#ifdef ENABLE_CHANNEL_CACHE
+// squelch calibration at the squelch level last used, VHF and UHF, and
+// TX power calibration, which only a UART EEPROM write changes
+static struct {
+    uint16_t Base;
+    uint8_t  Thresh[6];
+} gSquelchCalibration[2];
+static uint8_t  gTxPowerCalibration[BAND_N_ELEM][3][3];
+static uint32_t gTxPowerCalibrationValid;
+#endif
+
+static void LoadChannel(VFO_Info_t *pVfo, uint8_t channel, const unsigned int VFO, const unsigned int configure, const ChannelAttributes_t att);
+
+#ifdef ENABLE_SCAN_PREFETCH
+// the next scan channel, loaded while the scanner listens to the current one
+static VFO_Info_t gPrefetch;
+static uint8_t    gPrefetchChannel = 0xFF;
+static uint8_t    gPrefetchVfo;
+
+// the same config in pVfo as pConfig is in gPrefetch
+static FREQ_Config_t *PrefetchConfig(VFO_Info_t *pVfo, const FREQ_Config_t *pConfig)
+{
+    return (pConfig == &gPrefetch.freq_config_TX) ? &pVfo->freq_config_TX : &pVfo->freq_config_RX;
+}
+#endif
+
 const char gModulationStr[MODULATION_UKNOWN][4] = {
     [MODULATION_FM]="FM",
     [MODULATION_AM]="AM",
@@ -54,6 +81,16 @@ const char gModulationStr[MODULATION_UKNOWN][4] = {
 #endif
 };
 
+static bool IsScanListPriority(uint16_t channel, uint8_t scanList)
+{
+    // I don't understand what this code is for...
+
+    const uint8_t PriorityCh1 = gEeprom.SCANLIST_PRIORITY_CH1[scanList - 1];
+    const uint8_t PriorityCh2 = gEeprom.SCANLIST_PRIORITY_CH2[scanList - 1];
+
+    return PriorityCh1 == channel || PriorityCh2 == channel;
+}
+
 bool RADIO_CheckValidChannel(uint16_t channel, bool checkScanList, uint8_t scanList)
 {
     // return true if the channel appears valid
@@ -104,16 +141,119 @@ bool RADIO_CheckValidChannel(uint16_t channel, bool checkScanList, uint8_t scanL
 
     //return true;
 
-    // I don't understand what this code is for...
-    
-    const uint8_t PriorityCh1 = gEeprom.SCANLIST_PRIORITY_CH1[scanList - 1];
-    const uint8_t PriorityCh2 = gEeprom.SCANLIST_PRIORITY_CH2[scanList - 1];
+    return !IsScanListPriority(channel, scanList);
+}
+
+#ifdef ENABLE_SCAN_LIST_INDEX
+// one bit per memory channel that is valid, not excluded and in the list:
+// no list, list 1, 2, 3, any list, and any channel at all. The priority
+// channels are left in and skipped when found, as they are only a pair of
+// compares and may change without the channel attributes changing.
+#define SCAN_LIST_WORDS ((MR_CHANNEL_LAST + 32) / 32)
+
+static uint32_t gScanListMap[6][SCAN_LIST_WORDS];
+static bool     gScanListMapValid;
+
+void RADIO_InvalidateScanLists(void)
+{
+    gScanListMapValid = false;
+}
+
+static void ScanListBuild(void)
+{
+    memset(gScanListMap, 0, sizeof(gScanListMap));
+
+    for (unsigned int i = MR_CHANNEL_FIRST; IS_MR_CHANNEL(i); i++) {
+        const ChannelAttributes_t att = gMR_ChannelAttributes[i];
 
-    return PriorityCh1 != channel && PriorityCh2 != channel;
+        if (gMR_ChannelExclude[i] || att.band > BAND7_470MHz)
+            continue;
+
+        const uint32_t bit  = 1u << (i & 31);
+        uint32_t      *word = &gScanListMap[0][i >> 5];
+
+        if (!att.scanlist1 && !att.scanlist2 && !att.scanlist3)
+            word[0 * SCAN_LIST_WORDS] |= bit;
+        else
+            word[4 * SCAN_LIST_WORDS] |= bit;
+        if (att.scanlist1)
+            word[1 * SCAN_LIST_WORDS] |= bit;
+        if (att.scanlist2)
+            word[2 * SCAN_LIST_WORDS] |= bit;
+        if (att.scanlist3)
+            word[3 * SCAN_LIST_WORDS] |= bit;
+        word[5 * SCAN_LIST_WORDS] |= bit;
+    }
+
+    gScanListMapValid = true;
 }
 
+// nearest set bit from Channel on in Direction, without wrapping, -1 if none
+static int ScanListNext(const uint32_t *map, int Channel, int8_t Direction)
+{
+    if (Channel < MR_CHANNEL_FIRST || Channel > MR_CHANNEL_LAST)
+        return -1;
+
+    unsigned int i = Channel >> 5;
+
+    if (Direction > 0) {
+        uint32_t word = map[i] & (0xFFFFFFFFu << (Channel & 31));
+        while (word == 0) {
+            if (++i >= SCAN_LIST_WORDS)
+                return -1;
+            word = map[i];
+        }
+        return i * 32 + __builtin_ctz(word);
+    }
+
+    uint32_t word = map[i] & (0xFFFFFFFFu >> (31 - (Channel & 31)));
+    while (word == 0) {
+        if (i-- == 0)
+            return -1;
+        word = map[i];
+    }
+    return i * 32 + 31 - __builtin_clz(word);
+}
+#endif
+
 uint8_t RADIO_FindNextChannel(uint8_t Channel, int8_t Direction, bool bCheckScanList, uint8_t VFO)
 {
+#ifdef ENABLE_SCAN_LIST_INDEX
+    if (bCheckScanList && (Direction == 1 || Direction == -1)) {
+        if (Channel == 0xFF) {
+            Channel = MR_CHANNEL_LAST;
+        } else if (!IS_MR_CHANNEL(Channel)) {
+            Channel = MR_CHANNEL_FIRST;
+        }
+
+        if (!gScanListMapValid)
+            ScanListBuild();
+
+        const uint32_t *map     = gScanListMap[VFO > 4 ? 5 : VFO];
+        bool            wrapped = false;
+        int             next    = Channel;
+
+        while (true) {
+            next = ScanListNext(map, next, Direction);
+            if (next < 0) {
+                if (wrapped)
+                    return 0xFF;
+                wrapped = true;
+                next    = (Direction > 0) ? MR_CHANNEL_FIRST : MR_CHANNEL_LAST;
+                continue;
+            }
+
+            if (wrapped && (Direction > 0 ? next >= Channel : next <= Channel))
+                return 0xFF;    // all the way round
+
+            if (VFO > 4 || !IsScanListPriority(next, VFO))
+                return next;
+
+            next += Direction;
+        }
+    }
+#endif
+
     for (unsigned int i = 0; IS_MR_CHANNEL(i); i++, Channel += Direction) {
         if (Channel == 0xFF) {
             Channel = MR_CHANNEL_LAST;
@@ -214,6 +354,21 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
         return;
     }
 
+#ifdef ENABLE_SCAN_PREFETCH
+    if (configure == VFO_CONFIGURE_RELOAD && channel == gPrefetchChannel && VFO == gPrefetchVfo) {
+        *pVfo     = gPrefetch;
+        pVfo->pRX = PrefetchConfig(pVfo, gPrefetch.pRX);
+        pVfo->pTX = PrefetchConfig(pVfo, gPrefetch.pTX);
+        gPrefetchChannel = 0xFF;
+        return;
+    }
+#endif
+
+    LoadChannel(pVfo, channel, VFO, configure, att);
+}
+
+static void LoadChannel(VFO_Info_t *pVfo, uint8_t channel, const unsigned int VFO, const unsigned int configure, const ChannelAttributes_t att)
+{
     uint8_t band = att.band;
     if (band > BAND7_470MHz) {
         band = BAND6_400MHz;
@@ -251,10 +406,22 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
     {
         uint8_t tmp;
         uint8_t data[8];
+#ifdef ENABLE_CHANNEL_CACHE
+        uint8_t record[16];
+
+        if (IS_MR_CHANNEL(channel))
+            SETTINGS_FetchChannelRecord(channel, record);
+        else
+            EEPROM_ReadBuffer(base, record, sizeof(record));
+#endif
         
         // ***************
 
+#ifdef ENABLE_CHANNEL_CACHE
+        memcpy(data, record + 8, sizeof(data));
+#else
         EEPROM_ReadBuffer(base + 8, data, sizeof(data));
+#endif
 
         tmp = data[3] & 0x0F;
         if (tmp > TX_OFFSET_FREQUENCY_DIRECTION_SUB)
@@ -367,7 +534,11 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
             uint32_t Frequency;
             uint32_t Offset;
         } __attribute__((packed)) info;
+#ifdef ENABLE_CHANNEL_CACHE
+        memcpy(&info, record, sizeof(info));
+#else
         EEPROM_ReadBuffer(base, &info, sizeof(info));
+#endif
         if(info.Frequency==0xFFFFFFFF)
             pVfo->freq_config_RX.Frequency = frequencyBandTable[band].lower;
         else
@@ -442,6 +613,37 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
     RADIO_ConfigureSquelchAndOutputPower(pVfo);
 }
 
+#ifdef ENABLE_SCAN_PREFETCH
+void RADIO_PrefetchChannel(const unsigned int VFO, const uint8_t channel)
+{
+    gPrefetchChannel = 0xFF;
+
+    if (!RADIO_CheckValidChannel(channel, false, 0))
+        return;
+
+    // start from the VFO as it is, like RADIO_ConfigureChannel() does
+    gPrefetch = gEeprom.VfoInfo[VFO];
+    LoadChannel(&gPrefetch, channel, VFO, VFO_CONFIGURE_RELOAD, gMR_ChannelAttributes[channel]);
+
+    gPrefetchChannel = channel;
+    gPrefetchVfo     = VFO;
+}
+
+void RADIO_DropPrefetch(void)
+{
+    gPrefetchChannel = 0xFF;
+}
+#endif
+
+#ifdef ENABLE_CHANNEL_CACHE
+void RADIO_ClearCalibrationCache(void)
+{
+    gSquelchCalibration[0].Base = 0;
+    gSquelchCalibration[1].Base = 0;
+    gTxPowerCalibrationValid    = 0;
+}
+#endif
+
 void RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo)
 {
 
@@ -465,6 +667,22 @@ void RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo)
     else
     {   // squelch >= 1
         Base += gEeprom.SQUELCH_LEVEL;                                        // my eeprom squelch-1
+#ifdef ENABLE_CHANNEL_CACHE
+        uint8_t *Thresh = gSquelchCalibration[Band < BAND4_174MHz].Thresh;
+
+        if (gSquelchCalibration[Band < BAND4_174MHz].Base != Base) {
+            gSquelchCalibration[Band < BAND4_174MHz].Base = Base;
+            for (unsigned int i = 0; i < 6; i++)
+                EEPROM_ReadBuffer(Base + i * 0x10, &Thresh[i], 1);
+        }
+
+        pInfo->SquelchOpenRSSIThresh    = Thresh[0];
+        pInfo->SquelchCloseRSSIThresh   = Thresh[1];
+        pInfo->SquelchOpenNoiseThresh   = Thresh[2];
+        pInfo->SquelchCloseNoiseThresh  = Thresh[3];
+        pInfo->SquelchCloseGlitchThresh = Thresh[4];
+        pInfo->SquelchOpenGlitchThresh  = Thresh[5];
+#else
                                                                               // VHF   UHF
         EEPROM_ReadBuffer(Base + 0x00, &pInfo->SquelchOpenRSSIThresh,    1);  //  50    10
         EEPROM_ReadBuffer(Base + 0x10, &pInfo->SquelchCloseRSSIThresh,   1);  //  40     5
@@ -474,6 +692,7 @@ void RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo)
 
         EEPROM_ReadBuffer(Base + 0x40, &pInfo->SquelchCloseGlitchThresh, 1);  //  90    90
         EEPROM_ReadBuffer(Base + 0x50, &pInfo->SquelchOpenGlitchThresh,  1);  // 100   100
+#endif
 
 
         uint16_t noise_open   = pInfo->SquelchOpenNoiseThresh;
@@ -552,7 +771,15 @@ void RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo)
         currentPower--;
     }
 
+#ifdef ENABLE_CHANNEL_CACHE
+    if (!((gTxPowerCalibrationValid >> (Band * 3 + Op)) & 1u)) {
+        EEPROM_ReadBuffer(0x1ED0 + (Band * 16) + (Op * 3), gTxPowerCalibration[Band][Op], 3);
+        gTxPowerCalibrationValid |= 1u << (Band * 3 + Op);
+    }
+    memcpy(Txp, gTxPowerCalibration[Band][Op], 3);
+#else
     EEPROM_ReadBuffer(0x1ED0 + (Band * 16) + (Op * 3), Txp, 3);
+#endif
 
 #ifdef ENABLE_FEAT_F4HWN
     // make low and mid even lower
@@ -697,6 +924,8 @@ void RADIO_SetupRegisters(bool switchToForeground)
 
     gEnableSpeaker = false;
 
+    BK4819_BeginBatch();
+
     BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, false);
 
     switch (Bandwidth)
@@ -868,6 +1097,8 @@ void RADIO_SetupRegisters(bool switchToForeground)
     // enable/disable BK4819 selected interrupts
     BK4819_WriteRegister(BK4819_REG_3F, InterruptMask);
 
+    BK4819_Commit();
+
     FUNCTION_Init();
 
     if (switchToForeground)
@@ -908,7 +1139,7 @@ void RADIO_SetupRegisters(bool switchToForeground)
             {
                 gIsNoaaMode          = true;
                 gNoaaChannel         = gRxVfo->CHANNEL_SAVE - NOAA_CHANNEL_FIRST;
-                gNOAA_Countdown_10ms = NOAA_countdown_2_10ms;
+                TIMER_Arm(TIMER_NOAA, NOAA_countdown_2_10ms);
                 gScheduleNOAA        = false;
             }
             else
@@ -934,6 +1165,8 @@ void RADIO_SetTxParameters(void)
 
     gEnableSpeaker = false;
 
+    BK4819_BeginBatch();
+
     BK4819_ToggleGpioOut(BK4819_GPIO0_PIN28_RX_ENABLE, false);
 
     switch (Bandwidth)
@@ -960,6 +1193,8 @@ void RADIO_SetTxParameters(void)
 
     BK4819_PrepareTransmit();
 
+    BK4819_Commit();
+
     SYSTEM_DelayMs(10);
 
     BK4819_PickRXFilterPathBasedOnFrequency(gCurrentVfo->pTX->Frequency);
@@ -1078,7 +1313,7 @@ void RADIO_PrepareTX(void)
     if (gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
     {   // dual-RX is enabled
 
-        gDualWatchCountdown_10ms = dual_watch_count_after_tx_10ms;
+        TIMER_Arm(TIMER_DUAL_WATCH, dual_watch_count_after_tx_10ms);
         gScheduleDualWatch       = false;
 
         if (!gRxVfoIsActive)
@@ -152,8 +152,22 @@ extern VfoState_t     VfoState[2];
 
 bool     RADIO_CheckValidChannel(uint16_t channel, bool checkScanList, uint8_t scanList);
 uint8_t  RADIO_FindNextChannel(uint8_t ChNum, int8_t Direction, bool bCheckScanList, uint8_t RadioNum);
+#ifdef ENABLE_SCAN_LIST_INDEX
+// call after changing channel attributes or exclusions
+void     RADIO_InvalidateScanLists(void);
+#endif
 void     RADIO_InitInfo(VFO_Info_t *pInfo, const uint8_t ChannelSave, const uint32_t Frequency);
 void     RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure);
+#ifdef ENABLE_SCAN_PREFETCH
+// load a memory channel ahead of time, the next RADIO_ConfigureChannel()
+// reload of it on that VFO then only copies it in
+void     RADIO_PrefetchChannel(const unsigned int VFO, const uint8_t channel);
+void     RADIO_DropPrefetch(void);
+#endif
+#ifdef ENABLE_CHANNEL_CACHE
+// call after the calibration area (0x1E00..) is written behind our back
+void     RADIO_ClearCalibrationCache(void);
+#endif
 void     RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo);
 void     RADIO_ApplyOffset(VFO_Info_t *pInfo);
 void     RADIO_SelectVfos(void);
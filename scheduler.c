@@ -14,25 +14,42 @@
  *     limitations under the License.
  */
 
+#include <stddef.h>
+
 #include "app/chFrScanner.h"
 #ifdef ENABLE_FMRADIO
     #include "app/fm.h"
 #endif
+#include "app/profiler.h"
 #include "app/scanner.h"
 #include "audio.h"
 #include "functions.h"
 #include "helper/battery.h"
 #include "misc.h"
+#include "scheduler.h"
 #include "settings.h"
 
+#include "ARMCM0.h"
 #include "driver/backlight.h"
 #include "bsp/dp32g030/gpio.h"
 #include "driver/gpio.h"
+#ifdef ENABLE_TICKLESS_IDLE
+    #include "driver/systick.h"
+
+    #define NEAREST(cnt)                                   \
+        do {                                               \
+            if ((cnt) > 0 && (cnt) < gSchedulerSlack_10ms) \
+                gSchedulerSlack_10ms = (cnt);              \
+        } while (0)
+#else
+    #define NEAREST(cnt)
+#endif
 
 #define DECREMENT(cnt) \
     do {               \
         if (cnt > 0)   \
             cnt--;     \
+        NEAREST(cnt);  \
     } while (0)
 
 #define DECREMENT_AND_TRIGGER(cnt, flag) \
@@ -40,14 +57,149 @@
         if (cnt > 0)                     \
             if (--cnt == 0)              \
                 flag = true;             \
+        NEAREST(cnt);                    \
     } while (0)
 
-static volatile uint32_t gGlobalSysTickCounter;
+volatile uint32_t gGlobalSysTickCounter;
+
+#ifdef ENABLE_TICKLESS_IDLE
+    volatile uint8_t gSchedulerSlack_10ms;
+#endif
+
+typedef struct {
+    volatile bool *pFlag;           // set when it runs out, or NULL
+    bool         (*pCounting)(void); // held while this is false, NULL counts always
+} TimerInfo_t;
+
+static bool ScanPauseCounting(void)
+{
+    return gScanStateDir != SCAN_OFF &&
+           gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT;
+}
+
+static bool DualWatchCounting(void)
+{
+    return gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH != DUAL_WATCH_OFF &&
+           gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT &&
+           gCurrentFunction != FUNCTION_RECEIVE;
+}
+
+static bool BatterySaveCounting(void)
+{
+    return gCurrentFunction == FUNCTION_FOREGROUND;
+}
+
+static bool PowerSaveCounting(void)
+{
+    return gCurrentFunction == FUNCTION_POWER_SAVE;
+}
+
+#ifdef ENABLE_NOAA
+static bool NoaaCounting(void)
+{
+    return gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH == DUAL_WATCH_OFF &&
+           gIsNoaaMode && gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT &&
+           gCurrentFunction != FUNCTION_RECEIVE;
+}
+#endif
+
+static const TimerInfo_t TimerInfo[TIMER_COUNT] = {
+    [TIMER_SCAN_PAUSE]   = { &gScheduleScanListen,        ScanPauseCounting   },
+    [TIMER_DUAL_WATCH]   = { &gScheduleDualWatch,         DualWatchCounting   },
+    [TIMER_BATTERY_SAVE] = { &gSchedulePowerSave,         BatterySaveCounting },
+    [TIMER_POWER_SAVE]   = { &gPowerSaveCountdownExpired, PowerSaveCounting   },
+#ifdef ENABLE_NOAA
+    [TIMER_NOAA]         = { &gScheduleNOAA,              NoaaCounting        },
+    [TIMER_NOAA_HOLD]    = { NULL,                        NULL                },
+#endif
+#ifdef ENABLE_VOX
+    [TIMER_VOX_STOP]     = { NULL,                        NULL                },
+#endif
+    [TIMER_FOUND_CTCSS]  = { NULL,                        NULL                },
+    [TIMER_FOUND_CDCSS]  = { NULL,                        NULL                },
+};
+
+static uint32_t          gTimerDeadline[TIMER_COUNT];
+static volatile uint16_t gTimerArmed;   // one bit per TIMER_Id_t
+
+void TIMER_Arm(TIMER_Id_t Id, uint16_t Ticks)
+{
+    // the handler clears bits too, and this may run with interrupts off
+    const uint32_t PriMask = __get_PRIMASK();
+
+    __disable_irq();
+
+    if (Ticks > 0) {
+        gTimerDeadline[Id] = gGlobalSysTickCounter + Ticks;
+        gTimerArmed |= 1u << Id;
+    }
+    else
+        gTimerArmed &= ~(1u << Id);
+
+    __set_PRIMASK(PriMask);
+}
+
+void TIMER_Stop(TIMER_Id_t Id)
+{
+    TIMER_Arm(Id, 0);
+}
+
+uint16_t TIMER_Remaining(TIMER_Id_t Id)
+{
+    // in this order, a countdown that runs out meanwhile reads as 0
+    const uint32_t Now      = gGlobalSysTickCounter;
+    const uint32_t Deadline = gTimerDeadline[Id];
+
+    if (!(gTimerArmed & (1u << Id)))
+        return 0;
+
+    return Deadline - Now;
+}
+
+uint16_t TIMER_NextDeadline(void)
+{
+    const uint32_t Now     = gGlobalSysTickCounter;
+    uint32_t       Nearest = UINT16_MAX;
+    uint16_t       Armed   = gTimerArmed;
+
+    for (unsigned int Id = 0; Armed; Id++, Armed >>= 1) {
+        if (!(Armed & 1u))
+            continue;
+
+        // a held countdown can't run out before the main loop changes state
+        if (TimerInfo[Id].pCounting && !TimerInfo[Id].pCounting())
+            continue;
+
+        Nearest = MIN(Nearest, gTimerDeadline[Id] - Now);
+    }
+
+    return Nearest;
+}
+
+static void TIMER_Tick(void)
+{
+    const uint32_t Now   = gGlobalSysTickCounter;
+    uint16_t       Armed = gTimerArmed;
+
+    for (unsigned int Id = 0; Armed; Id++, Armed >>= 1) {
+        if (!(Armed & 1u))
+            continue;
+
+        const TimerInfo_t *pInfo = &TimerInfo[Id];
+
+        if (pInfo->pCounting && !pInfo->pCounting())
+            gTimerDeadline[Id]++;   // held, like a counter that isn't decremented
+        else if (gTimerDeadline[Id] == Now) {
+            gTimerArmed &= ~(1u << Id);
+            if (pInfo->pFlag)
+                *pInfo->pFlag = true;
+        }
+    }
+}
 
 void SystickHandler(void);
 
-// we come here every 10ms
-void SystickHandler(void)
+static void Tick(void)
 {
     gGlobalSysTickCounter++;
     
@@ -67,37 +219,16 @@ void SystickHandler(void)
         DECREMENT(gSerialConfigCountDown_500ms);
     }
 
-    if ((gGlobalSysTickCounter & 3) == 0)
-        gNextTimeslice40ms = true;
-
-#ifdef ENABLE_NOAA
-    DECREMENT(gNOAACountdown_10ms);
+#ifdef ENABLE_TICKLESS_IDLE
+    // only the 10 ms counters below bound it, and those that are stopped
+    // count as far away, the TIMER_* ones are in TIMER_NextDeadline()
+    gSchedulerSlack_10ms = UINT8_MAX;
 #endif
 
-    DECREMENT(gFoundCDCSSCountdown_10ms);
-
-    DECREMENT(gFoundCTCSSCountdown_10ms);
-
-    if (gCurrentFunction == FUNCTION_FOREGROUND)
-        DECREMENT_AND_TRIGGER(gBatterySaveCountdown_10ms, gSchedulePowerSave);
-
-    if (gCurrentFunction == FUNCTION_POWER_SAVE)
-        DECREMENT_AND_TRIGGER(gPowerSave_10ms, gPowerSaveCountdownExpired);
-
-    if (gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH != DUAL_WATCH_OFF)
-        if (gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT && gCurrentFunction != FUNCTION_RECEIVE)
-            DECREMENT_AND_TRIGGER(gDualWatchCountdown_10ms, gScheduleDualWatch);
-
-#ifdef ENABLE_NOAA
-    if (gScanStateDir == SCAN_OFF && !gCssBackgroundScan && gEeprom.DUAL_WATCH == DUAL_WATCH_OFF)
-        if (gIsNoaaMode && gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT)
-            if (gCurrentFunction != FUNCTION_RECEIVE)
-                DECREMENT_AND_TRIGGER(gNOAA_Countdown_10ms, gScheduleNOAA);
-#endif
+    if ((gGlobalSysTickCounter & 3) == 0)
+        gNextTimeslice40ms = true;
 
-    if (gScanStateDir != SCAN_OFF)
-        if (gCurrentFunction != FUNCTION_MONITOR && gCurrentFunction != FUNCTION_TRANSMIT)
-            DECREMENT_AND_TRIGGER(gScanPauseDelayIn_10ms, gScheduleScanListen);
+    TIMER_Tick();
 
     DECREMENT_AND_TRIGGER(gTailNoteEliminationCountdown_10ms, gFlagTailNoteEliminationComplete);
 
@@ -111,9 +242,22 @@ void SystickHandler(void)
             DECREMENT_AND_TRIGGER(gFmPlayCountdown_10ms, gScheduleFM);
 #endif
 
-#ifdef ENABLE_VOX
-    DECREMENT(gVoxStopCountdown_10ms);
+    DECREMENT(boot_counter_10ms);
+}
+
+// we come here every 10ms, or after a longer sleep see APP_Idle()
+void SystickHandler(void)
+{
+#ifdef ENABLE_PROFILER
+    // the main loop has not picked up the previous 10 ms slice yet
+    if (gNextTimeslice)
+        gProfilerMissedSlices++;
 #endif
 
-    DECREMENT(boot_counter_10ms);
+#ifdef ENABLE_TICKLESS_IDLE
+    for (uint32_t Ticks = SYSTICK_Wake(); Ticks > 0; Ticks--)
+        Tick();
+#else
+    Tick();
+#endif
 }
@@ -0,0 +1,52 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+// Countdowns in 10 ms ticks, kept as deadlines on gGlobalSysTickCounter so
+// that only the armed ones cost anything per tick. Each sets its flag in
+// scheduler.c when it runs out, and some only count while the radio is in
+// a given state, just as the hand-decremented counters they replace.
+typedef enum {
+    TIMER_SCAN_PAUSE,       // gScheduleScanListen, while scanning
+    TIMER_DUAL_WATCH,       // gScheduleDualWatch, while dual watch is idle
+    TIMER_BATTERY_SAVE,     // gSchedulePowerSave, in FUNCTION_FOREGROUND
+    TIMER_POWER_SAVE,       // gPowerSaveCountdownExpired, in FUNCTION_POWER_SAVE
+#ifdef ENABLE_NOAA
+    TIMER_NOAA,             // gScheduleNOAA, while NOAA watch is idle
+    TIMER_NOAA_HOLD,        // no flag, stay on a NOAA channel after a signal
+#endif
+#ifdef ENABLE_VOX
+    TIMER_VOX_STOP,         // no flag, VOX hang time
+#endif
+    TIMER_FOUND_CTCSS,      // no flag, CTCSS hold after a match
+    TIMER_FOUND_CDCSS,      // no flag, DCS hold after a match
+    TIMER_COUNT
+} TIMER_Id_t;
+
+// (re)start a countdown, 0 stops it
+void     TIMER_Arm(TIMER_Id_t Id, uint16_t Ticks);
+void     TIMER_Stop(TIMER_Id_t Id);
+// ticks left, 0 once it has run out or was stopped
+uint16_t TIMER_Remaining(TIMER_Id_t Id);
+// ticks until the nearest armed countdown that is counting runs out,
+// UINT16_MAX when there is none
+uint16_t TIMER_NextDeadline(void);
+
+#endif
@@ -0,0 +1,142 @@
+/* Copyright 2024 Armel F4HWN
+ * https://github.com/armel
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#include <string.h>
+
+#include "driver/crc.h"
+#include "driver/st7565.h"
+#include "driver/uart.h"
+#include "screenshot.h"
+
+#define PAGE_COUNT   (1 + FRAME_LINES)
+#define PACKED_MAX   (LCD_WIDTH + 1)    // one literal run of the whole page
+#define FRAME_HEADER 6                  // magic, type, size, page mask
+
+static bool     gMirror;
+static uint8_t  gMirrorNext;            // round robin, so no page starves
+static uint8_t  gMirrorSent;            // pages whose CRC below is valid
+static uint16_t gMirrorCrc[PAGE_COUNT];
+
+static const uint8_t *getPage(unsigned int page)
+{
+    return (page == 0) ? gStatusLine : gFrameBuffer[page - 1];
+}
+
+// PackBits: n < 128 is followed by n + 1 literal bytes, n > 128 by one byte
+// repeated 257 - n times. Only runs of 3 or more are worth a header, which
+// keeps the worst case at one literal run of the whole page.
+static unsigned int packPage(const uint8_t *src, uint8_t *dst)
+{
+    unsigned int i   = 0;
+    unsigned int out = 0;
+
+    while (i < LCD_WIDTH)
+    {
+        unsigned int run = 1;
+
+        while (i + run < LCD_WIDTH && run < 128 && src[i + run] == src[i])
+            run++;
+
+        if (run >= 3)
+        {
+            dst[out++] = 257 - run;
+            dst[out++] = src[i];
+            i += run;
+            continue;
+        }
+
+        const unsigned int start = i;
+
+        while (i < LCD_WIDTH && i - start < 128 &&
+               !(i + 2 < LCD_WIDTH && src[i] == src[i + 1] && src[i] == src[i + 2]))
+            i++;
+
+        dst[out++] = i - start - 1;
+        memcpy(dst + out, src + start, i - start);
+        out += i - start;
+    }
+
+    return out;
+}
+
+static void setHeader(uint8_t *header, unsigned int size, uint8_t mask)
+{
+    header[0] = 0xAA;
+    header[1] = 0x55;
+    header[2] = 0x01;
+    header[3] = size & 0xFF;
+    header[4] = size >> 8;
+    header[5] = mask;
+}
+
+void getScreenShot(void)
+{
+    uint8_t      packed[PACKED_MAX];
+    uint8_t      header[FRAME_HEADER];
+    unsigned int size = 1;
+
+    // packing is cheap next to the link, so pack twice rather than keep 1 KB
+    for (unsigned int page = 0; page < PAGE_COUNT; page++)
+        size += packPage(getPage(page), packed);
+
+    setHeader(header, size, 0xFF);
+    UART_Send(header, sizeof(header));
+
+    for (unsigned int page = 0; page < PAGE_COUNT; page++)
+    {
+        UART_Send(packed, packPage(getPage(page), packed));
+        gMirrorCrc[page] = CRC_Calculate(getPage(page), LCD_WIDTH);
+    }
+
+    gMirrorSent = 0xFF;
+}
+
+void setScreenShotMirror(bool enable)
+{
+    gMirror     = enable;
+    gMirrorSent = 0;
+}
+
+void mirrorScreenShot(void)
+{
+    uint8_t frame[FRAME_HEADER + PACKED_MAX];
+
+    if (!gMirror)
+        return;
+
+    for (unsigned int i = 0; i < PAGE_COUNT; i++)
+    {
+        const unsigned int page = (gMirrorNext + i) % PAGE_COUNT;
+        const uint16_t     crc  = CRC_Calculate(getPage(page), LCD_WIDTH);
+
+        if ((gMirrorSent & (1u << page)) && crc == gMirrorCrc[page])
+            continue;
+
+        const unsigned int size = packPage(getPage(page), frame + FRAME_HEADER);
+
+        // no room, the page stays dirty and goes out on a later tick
+        if (UART_TxFree() < FRAME_HEADER + size)
+            return;
+
+        setHeader(frame, 1 + size, 1u << page);
+        UART_SendAsync(frame, FRAME_HEADER + size);
+
+        gMirrorCrc[page] = crc;
+        gMirrorSent     |= 1u << page;
+        gMirrorNext      = (page + 1) % PAGE_COUNT;
+        return;
+    }
+}
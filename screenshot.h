@@ -14,38 +14,20 @@
  *     limitations under the License.
  */
 
-#include "debugging.h"
-#include "driver/st7565.h"
+#ifndef SCREENSHOT_H
+#define SCREENSHOT_H
 
-static inline void getScreenShot(void)
-{
-    char str[2] = "";
+#include <stdbool.h>
 
-    LogUart("P1\n");
-    LogUart("128 64\n");
+// Screen frames: 0xAA 0x55, type 0x01, payload size (u16 LE), then a page
+// mask (bit 0 is the status line, bits 1-7 the frame buffer lines) and the
+// PackBits encoding of each page in the mask, 128 bytes each once unpacked.
 
-    for(uint8_t b = 0; b < 8; b++)
-    {
-        for(uint8_t i = 0; i < 128; i++)
-        {
-            sprintf(str, "%d ", ((gStatusLine[i] >> b)  & 0x01));
-            LogUart(str);
-        }
-        LogUart("\n");
-    }
+// the whole screen, waits for room in the TX queue
+void getScreenShot(void);
+// continuous mode, only pages that changed since they were last sent
+void setScreenShotMirror(bool enable);
+// called every 10 ms, sends at most one changed page and never waits
+void mirrorScreenShot(void);
 
-    for(uint8_t l = 0; l < 7; l++)
-    {
-        for(uint8_t b = 0; b < 8; b++)
-        {
-            for(uint8_t i = 0; i < 128; i++)
-            {
-                sprintf(str, "%d ", ((gFrameBuffer[l][i] >> b)  & 0x01));
-                LogUart(str);
-            }
-        }
-        LogUart("\n");
-    }
-
-    LogUart("\n----------------\n");
-}
\ No newline at end of file
+#endif
@@ -43,6 +43,10 @@ EEPROM_Config_t gEeprom = { 0 };
 void SETTINGS_InitEEPROM(void)
 {
     uint8_t Data[16] = {0};
+
+    // VFO state saved since the last boot may only be in the journal
+    EEPROM_ReplayJournal();
+
     // 0E70..0E77
     EEPROM_ReadBuffer(0x0E70, Data, 8);
     gEeprom.CHAN_1_CALL          = IS_MR_CHANNEL(Data[0]) ? Data[0] : MR_CHANNEL_FIRST;
@@ -326,6 +330,16 @@ void SETTINGS_InitEEPROM(void)
         gMR_ChannelExclude[i] = false;
     }
 
+#ifdef ENABLE_CHANNEL_INDEX
+    SETTINGS_BuildChannelIndex();
+#endif
+#ifdef ENABLE_CHANNEL_CACHE
+    SETTINGS_ClearChannelCache();
+#endif
+#ifdef ENABLE_SCAN_LIST_INDEX
+    RADIO_InvalidateScanLists();
+#endif
+
         // 0F30..0F3F
         EEPROM_ReadBuffer(0x0F30, gCustomAesKey, sizeof(gCustomAesKey));
         bHasCustomAesKey = false;
@@ -453,6 +467,68 @@ void SETTINGS_LoadCalibration(void)
     }
 }
 
+#ifdef ENABLE_CHANNEL_CACHE
+// Records and raw names of the first memory channels read since the cache
+// was last cleared. It fills up and then stays put rather than evicting,
+// so a scan list longer than the cache still hits on the first
+// CHANNEL_CACHE_SLOTS channels of every pass.
+#define CHANNEL_CACHE_SLOTS 32
+
+static struct {
+    uint8_t channel;        // 0xFF = free slot
+    uint8_t record[16];
+    char    name[10];
+} gChannelCache[CHANNEL_CACHE_SLOTS];
+static uint8_t gChannelCacheCount;
+
+void SETTINGS_ClearChannelCache(void)
+{
+    gChannelCacheCount = 0;
+}
+
+static void ChannelCacheDrop(uint8_t channel)
+{
+    for (unsigned int i = 0; i < gChannelCacheCount; i++)
+        if (gChannelCache[i].channel == channel)
+            gChannelCache[i].channel = 0xFF;
+}
+
+// the channel's slot, filled on first use, NULL once the cache is full
+static const uint8_t *ChannelCacheGet(uint8_t channel, bool name)
+{
+    int slot = -1;
+
+    for (unsigned int i = 0; i < gChannelCacheCount; i++) {
+        if (gChannelCache[i].channel == channel)
+            return name ? (const uint8_t *)gChannelCache[i].name : gChannelCache[i].record;
+        if (gChannelCache[i].channel == 0xFF && slot < 0)
+            slot = i;
+    }
+
+    if (slot < 0) {
+        if (gChannelCacheCount >= CHANNEL_CACHE_SLOTS)
+            return NULL;
+        slot = gChannelCacheCount++;
+    }
+
+    gChannelCache[slot].channel = channel;
+    EEPROM_ReadBuffer(channel * 16, gChannelCache[slot].record, sizeof(gChannelCache[slot].record));
+    EEPROM_ReadBuffer(0x0F50 + (channel * 16), gChannelCache[slot].name, sizeof(gChannelCache[slot].name));
+
+    return name ? (const uint8_t *)gChannelCache[slot].name : gChannelCache[slot].record;
+}
+
+void SETTINGS_FetchChannelRecord(uint8_t channel, void *pRecord)
+{
+    const uint8_t *pCached = IS_MR_CHANNEL(channel) ? ChannelCacheGet(channel, false) : NULL;
+
+    if (pCached)
+        memcpy(pRecord, pCached, 16);
+    else
+        EEPROM_ReadBuffer(channel * 16, pRecord, 16);
+}
+#endif
+
 uint32_t SETTINGS_FetchChannelFrequency(const int channel)
 {
     struct
@@ -479,6 +555,12 @@ void SETTINGS_FetchChannelName(char *s, const int channel)
     if (!RADIO_CheckValidChannel(channel, false, 0))
         return;
 
+#ifdef ENABLE_CHANNEL_CACHE
+    const uint8_t *pCached = ChannelCacheGet(channel, true);
+    if (pCached)
+        memcpy(s, pCached, 10);
+    else
+#endif
     EEPROM_ReadBuffer(0x0F50 + (channel * 16), s, 10);
 
     int i;
@@ -492,34 +574,186 @@ void SETTINGS_FetchChannelName(char *s, const int channel)
         s[i--] = 0;               // null term
 }
 
+#ifdef ENABLE_CHANNEL_INDEX
+static uint32_t gChannelIndexFrequency[MR_CHANNEL_LAST + 1];
+static uint8_t  gChannelIndexChannel[MR_CHANNEL_LAST + 1];
+static uint8_t  gChannelIndexCount;
+static bool     gChannelIndexStale;     // the EEPROM changed under it
+
+// names of the channels last asked for, 0xFF = free slot
+static struct {
+    uint8_t channel;
+    char    name[11];
+} gChannelNameCache[4];
+static uint8_t gChannelNameCacheNext;
+
+// first entry not ordered before (frequency, channel)
+static unsigned int ChannelIndexLowerBound(uint32_t frequency, uint8_t channel)
+{
+    unsigned int lo = 0;
+    unsigned int hi = gChannelIndexCount;
+
+    while (lo < hi) {
+        const unsigned int mid = (lo + hi) / 2;
+
+        if (gChannelIndexFrequency[mid] < frequency ||
+            (gChannelIndexFrequency[mid] == frequency && gChannelIndexChannel[mid] < channel))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+static void ChannelIndexInsert(uint32_t frequency, uint8_t channel)
+{
+    const unsigned int i = ChannelIndexLowerBound(frequency, channel);
+    const unsigned int n = gChannelIndexCount - i;
+
+    memmove(&gChannelIndexFrequency[i + 1], &gChannelIndexFrequency[i], n * sizeof(gChannelIndexFrequency[0]));
+    memmove(&gChannelIndexChannel[i + 1], &gChannelIndexChannel[i], n);
+    gChannelIndexFrequency[i] = frequency;
+    gChannelIndexChannel[i]   = channel;
+    gChannelIndexCount++;
+}
+
+static void ChannelNameCacheDrop(uint8_t channel)
+{
+    for (unsigned int i = 0; i < ARRAY_SIZE(gChannelNameCache); i++)
+        if (gChannelNameCache[i].channel == channel)
+            gChannelNameCache[i].channel = 0xFF;
+}
+
+// the channel's frequency, name or validity may have changed
+static void ChannelIndexUpdate(uint8_t channel)
+{
+    if (!IS_MR_CHANNEL(channel))
+        return;
+
+    ChannelNameCacheDrop(channel);
+
+    for (unsigned int i = 0; i < gChannelIndexCount; i++) {
+        if (gChannelIndexChannel[i] == channel) {
+            const unsigned int n = gChannelIndexCount - i - 1;
+
+            memmove(&gChannelIndexFrequency[i], &gChannelIndexFrequency[i + 1], n * sizeof(gChannelIndexFrequency[0]));
+            memmove(&gChannelIndexChannel[i], &gChannelIndexChannel[i + 1], n);
+            gChannelIndexCount--;
+            break;
+        }
+    }
+
+    if (RADIO_CheckValidChannel(channel, false, 0))
+        ChannelIndexInsert(SETTINGS_FetchChannelFrequency(channel), channel);
+}
+
+void SETTINGS_BuildChannelIndex(void)
+{
+    gChannelIndexCount = 0;
+    gChannelIndexStale = false;
+    memset(gChannelNameCache, 0xFF, sizeof(gChannelNameCache));
+
+    // 0000..0C7F, eight records per read, skipping blocks with no valid channel
+    for (unsigned int first = 0; first <= MR_CHANNEL_LAST; first += 8) {
+        struct {
+            uint32_t frequency;
+            uint8_t  unused[12];
+        } __attribute__((packed)) records[8];
+        bool fetched = false;
+
+        for (unsigned int channel = first; channel < first + 8 && IS_MR_CHANNEL(channel); channel++) {
+            if (!RADIO_CheckValidChannel(channel, false, 0))
+                continue;
+
+            if (!fetched) {
+                EEPROM_ReadBuffer(first * 16, records, sizeof(records));
+                fetched = true;
+            }
+
+            ChannelIndexInsert(records[channel - first].frequency, channel);
+        }
+    }
+}
+
+void SETTINGS_InvalidateChannelIndex(void)
+{
+    memset(gChannelNameCache, 0xFF, sizeof(gChannelNameCache));
+    gChannelIndexStale = true;
+}
+
+int SETTINGS_FindChannelByFrequency(uint32_t frequency)
+{
+    if (gChannelIndexStale)
+        SETTINGS_BuildChannelIndex();
+
+    const unsigned int i = ChannelIndexLowerBound(frequency, 0);
+
+    if (i < gChannelIndexCount && gChannelIndexFrequency[i] == frequency)
+        return gChannelIndexChannel[i];
+
+    return -1;
+}
+
+void SETTINGS_FetchChannelNameCached(char *s, const int channel)
+{
+    for (unsigned int i = 0; i < ARRAY_SIZE(gChannelNameCache); i++) {
+        if (gChannelNameCache[i].channel == channel) {
+            strcpy(s, gChannelNameCache[i].name);
+            return;
+        }
+    }
+
+    SETTINGS_FetchChannelName(s, channel);
+
+    if (!IS_MR_CHANNEL(channel))
+        return;
+
+    gChannelNameCache[gChannelNameCacheNext].channel = channel;
+    strcpy(gChannelNameCache[gChannelNameCacheNext].name, s);
+    gChannelNameCacheNext = (gChannelNameCacheNext + 1) % ARRAY_SIZE(gChannelNameCache);
+}
+#endif
+
+static bool FactoryResetWipes(uint16_t i, bool bIsAll)
+{
+    return
+        !(i >= 0x0EE0 && i < 0x0F18) &&         // ANI ID + DTMF codes
+        !(i >= 0x0F30 && i < 0x0F50) &&         // AES KEY + F LOCK + Scramble Enable
+        !(i >= 0x1C00 && i < 0x1E00) &&         // DTMF contacts
+        !(i >= 0x0EB0 && i < 0x0ED0) &&         // Welcome strings
+        !(i >= 0x0EA0 && i < 0x0EA8) &&         // Voice Prompt
+        (bIsAll ||
+        (
+            !(i >= 0x0D60 && i < 0x0E28) &&     // MR Channel Attributes
+            !(i >= 0x0F18 && i < 0x0F30) &&     // Scan List
+            !(i >= 0x0F50 && i < 0x1C00) &&     // MR Channel Names
+            !(i >= 0x0E40 && i < 0x0E70) &&     // FM Channels
+            !(i >= 0x0E88 && i < 0x0E90)        // FM settings
+            ));
+}
+
 void SETTINGS_FactoryReset(bool bIsAll)
 {
     uint16_t i;
-    uint8_t  Template[8];
+    uint8_t  Size;
+    uint8_t  Template[EEPROM_PAGE_SIZE];
 
     memset(Template, 0xFF, sizeof(Template));
 
     //for (i = 0x0C80; i < 0x1E00; i += 8)
-    for (i = 0x0000; i < 0x1E00; i += 8)
+    for (i = 0x0000; i < 0x1E00; i += Size)
     {
-        if (
-            !(i >= 0x0EE0 && i < 0x0F18) &&         // ANI ID + DTMF codes
-            !(i >= 0x0F30 && i < 0x0F50) &&         // AES KEY + F LOCK + Scramble Enable
-            !(i >= 0x1C00 && i < 0x1E00) &&         // DTMF contacts
-            !(i >= 0x0EB0 && i < 0x0ED0) &&         // Welcome strings
-            !(i >= 0x0EA0 && i < 0x0EA8) &&         // Voice Prompt
-            (bIsAll ||
-            (
-                !(i >= 0x0D60 && i < 0x0E28) &&     // MR Channel Attributes
-                !(i >= 0x0F18 && i < 0x0F30) &&     // Scan List
-                !(i >= 0x0F50 && i < 0x1C00) &&     // MR Channel Names
-                !(i >= 0x0E40 && i < 0x0E70) &&     // FM Channels
-                !(i >= 0x0E88 && i < 0x0E90)        // FM settings
-                ))
-            )
-        {
-            EEPROM_WriteBuffer(i, Template);
-        }
+        Size = 8;
+
+        if (!FactoryResetWipes(i, bIsAll))
+            continue;
+
+        // as much of the page as is wiped goes in one write
+        while ((i + Size) % EEPROM_PAGE_SIZE && FactoryResetWipes(i + Size, bIsAll))
+            Size += 8;
+
+        EEPROM_WritePage(i, Template, Size);
     }
 
     if (bIsAll)
@@ -843,38 +1077,46 @@ void SETTINGS_SaveChannel(uint8_t Channel, uint8_t VFO, const VFO_Info_t *pVFO,
 
     if (Mode >= 2 || IS_FREQ_CHANNEL(Channel)) { // copy VFO to a channel
         union {
-            uint8_t _8[8];
-            uint32_t _32[2];
+            uint8_t _8[16];
+            uint32_t _32[4];
         } State;
 
         State._32[0] = pVFO->freq_config_RX.Frequency;
         State._32[1] = pVFO->TX_OFFSET_FREQUENCY;
-        EEPROM_WriteBuffer(OffsetVFO + 0, State._32);
 
-        State._8[0] =  pVFO->freq_config_RX.Code;
-        State._8[1] =  pVFO->freq_config_TX.Code;
-        State._8[2] = (pVFO->freq_config_TX.CodeType << 4) | pVFO->freq_config_RX.CodeType;
-        State._8[3] = (pVFO->Modulation << 4) | pVFO->TX_OFFSET_FREQUENCY_DIRECTION;
-        State._8[4] = 0
+        State._8[8]  =  pVFO->freq_config_RX.Code;
+        State._8[9]  =  pVFO->freq_config_TX.Code;
+        State._8[10] = (pVFO->freq_config_TX.CodeType << 4) | pVFO->freq_config_RX.CodeType;
+        State._8[11] = (pVFO->Modulation << 4) | pVFO->TX_OFFSET_FREQUENCY_DIRECTION;
+        State._8[12] = 0
             | (pVFO->TX_LOCK << 6)
             | (pVFO->BUSY_CHANNEL_LOCK << 5)
             | (pVFO->OUTPUT_POWER      << 2)
             | (pVFO->CHANNEL_BANDWIDTH << 1)
             | (pVFO->FrequencyReverse  << 0);
-        State._8[5] = ((pVFO->DTMF_PTT_ID_TX_MODE & 7u) << 1)
+        State._8[13] = ((pVFO->DTMF_PTT_ID_TX_MODE & 7u) << 1)
 #ifdef ENABLE_DTMF_CALLING
             | ((pVFO->DTMF_DECODING_ENABLE & 1u) << 0)
 #endif
         ;
-        State._8[6] =  pVFO->STEP_SETTING;
+        State._8[14] =  pVFO->STEP_SETTING;
 #ifdef ENABLE_FEAT_F4HWN
-        State._8[7] =  0;
+        State._8[15] =  0;
 #else
-        State._8[7] =  pVFO->SCRAMBLING_TYPE;
+        State._8[15] =  pVFO->SCRAMBLING_TYPE;
 #endif
-        EEPROM_WriteBuffer(OffsetVFO + 8, State._8);
+        EEPROM_WritePage(OffsetVFO, State._8, sizeof(State));
 
+#ifdef ENABLE_CHANNEL_CACHE
+        ChannelCacheDrop(Channel);
+#endif
+#ifdef ENABLE_SCAN_PREFETCH
+        RADIO_DropPrefetch();
+#endif
         SETTINGS_UpdateChannel(Channel, pVFO, true, true, true);
+#ifdef ENABLE_CHANNEL_INDEX
+        ChannelIndexUpdate(Channel);
+#endif
 
         if (IS_MR_CHANNEL(Channel)) {
 #ifndef ENABLE_KEEP_MEM_NAME
@@ -905,8 +1147,16 @@ void SETTINGS_SaveChannelName(uint8_t channel, const char * name)
     uint16_t offset = channel * 16;
     uint8_t buf[16] = {0};
     memcpy(buf, name, MIN(strlen(name), 10u));
-    EEPROM_WriteBuffer(0x0F50 + offset, buf);
-    EEPROM_WriteBuffer(0x0F58 + offset, buf + 8);
+    EEPROM_WritePage(0x0F50 + offset, buf, sizeof(buf));
+#ifdef ENABLE_CHANNEL_INDEX
+    ChannelNameCacheDrop(channel);
+#endif
+#ifdef ENABLE_CHANNEL_CACHE
+    ChannelCacheDrop(channel);
+#endif
+#ifdef ENABLE_SCAN_PREFETCH
+    RADIO_DropPrefetch();
+#endif
 }
 
 void SETTINGS_UpdateChannel(uint8_t channel, const VFO_Info_t *pVFO, bool keep, bool check, bool save)
@@ -949,6 +1199,18 @@ void SETTINGS_UpdateChannel(uint8_t channel, const VFO_Info_t *pVFO, bool keep,
 #endif
 
         gMR_ChannelAttributes[channel] = att;
+#ifdef ENABLE_CHANNEL_INDEX
+        ChannelIndexUpdate(channel);
+#endif
+#ifdef ENABLE_CHANNEL_CACHE
+        ChannelCacheDrop(channel);
+#endif
+#ifdef ENABLE_SCAN_PREFETCH
+        RADIO_DropPrefetch();
+#endif
+#ifdef ENABLE_SCAN_LIST_INDEX
+        RADIO_InvalidateScanLists();
+#endif
 
         if (IS_MR_CHANNEL(channel)) {   // it's a memory channel
             if (!keep) {
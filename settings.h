@@ -126,6 +126,9 @@ enum ACTION_OPT_t {
 #ifdef ENABLE_REGA
     ACTION_OPT_REGA_ALARM,
     ACTION_OPT_REGA_TEST,
+#endif
+#ifdef ENABLE_PROFILER
+    ACTION_OPT_PROFILER,
 #endif
     ACTION_OPT_LEN
 };
@@ -310,6 +313,24 @@ void     SETTINGS_InitEEPROM(void);
 void     SETTINGS_LoadCalibration(void);
 uint32_t SETTINGS_FetchChannelFrequency(const int channel);
 void     SETTINGS_FetchChannelName(char *s, const int channel);
+#ifdef ENABLE_CHANNEL_INDEX
+    // valid memory channels sorted by frequency, kept in RAM
+    void SETTINGS_BuildChannelIndex(void);
+    // channel records or names were written behind its back: forget the
+    // names now, rebuild the index on the next lookup
+    void SETTINGS_InvalidateChannelIndex(void);
+    // lowest valid memory channel on that frequency or -1, no EEPROM access
+    // unless the index has to be rebuilt
+    int  SETTINGS_FindChannelByFrequency(uint32_t frequency);
+    // SETTINGS_FetchChannelName() that remembers the last few names
+    void SETTINGS_FetchChannelNameCached(char *s, const int channel);
+#endif
+#ifdef ENABLE_CHANNEL_CACHE
+    // the 16-byte record of a memory channel, from RAM once it has been read
+    void SETTINGS_FetchChannelRecord(uint8_t channel, void *pRecord);
+    // start caching afresh, e.g. for the scan list about to be scanned
+    void SETTINGS_ClearChannelCache(void);
+#endif
 void     SETTINGS_FactoryReset(bool bIsAll);
 #ifdef ENABLE_FMRADIO
     void SETTINGS_SaveFM(void);
@@ -0,0 +1,63 @@
+/* Copyright 2023 Dual Tachyon
+ * https://github.com/DualTachyon
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *     Unless required by applicable law or agreed to in writing, software
+ *     distributed under the License is distributed on an "AS IS" BASIS,
+ *     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *     See the License for the specific language governing permissions and
+ *     limitations under the License.
+ */
+
+#ifdef ENABLE_PROFILER
+
+#include <string.h>
+
+#include "app/profiler.h"
+#include "driver/st7565.h"
+#include "external/printf/printf.h"
+#include "misc.h"
+#include "ui/helper.h"
+#include "ui/profiler.h"
+
+// min, mean and max in microseconds, 18 columns of the small font
+void UI_DisplayProfiler(void)
+{
+    static const char Names[PROFILER_N_ELEM][5] = {
+        [PROFILER_APP_UPDATE]       = "UPD",
+        [PROFILER_TIMESLICE_10MS]   = "10MS",
+        [PROFILER_TIMESLICE_500MS]  = "500M",
+        [PROFILER_DISPLAY_SCREEN]   = "GUI",
+        [PROFILER_RADIO_INTERRUPTS] = "IRQ",
+        [PROFILER_AM_FIX]           = "AMFX",
+        [PROFILER_UART_COMMAND]     = "UART",
+    };
+    char String[20];
+
+    memset(gStatusLine, 0, sizeof(gStatusLine));
+    sprintf(String, "LOAD %u%% MISS %u", PROFILER_LoadPercent(), (unsigned)gProfilerMissedSlices);
+    UI_PrintStringSmallBufferNormal(String, gStatusLine);
+
+    UI_DisplayClear();
+
+    for (unsigned int i = 0; i < PROFILER_N_ELEM; i++) {
+        const PROFILER_Stats_t *pStats = &gProfilerStats[i];
+        const uint32_t          Mean   = pStats->Count ? pStats->TotalUs / pStats->Count : 0;
+
+        sprintf(String, "%-4s%4u%5u%5u", Names[i],
+            (unsigned)MIN(pStats->MinUs, 9999u),
+            (unsigned)MIN(Mean, 99999u),
+            (unsigned)MIN(pStats->MaxUs, 99999u));
+        UI_PrintStringSmallNormal(String, 0, 0, i);
+    }
+
+    ST7565_BlitStatusLine();
+    ST7565_BlitFullScreen();
+}
+
+#endif
@@ -59,6 +59,12 @@ void UI_DisplayStatus()
     char str[8] = "";
 
     gUpdateStatus = false;
+
+#ifdef ENABLE_PROFILER
+    if (gScreenToDisplay == DISPLAY_PROFILER)
+        return;     // the profiler screen draws its own summary there
+#endif
+
     memset(gStatusLine, 0, sizeof(gStatusLine));
 
     uint8_t     *line = gStatusLine;
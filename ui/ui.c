@@ -33,9 +33,11 @@
 #ifdef ENABLE_REGA
     #include "app/rega.h"
 #endif
+#include "app/profiler.h"
 #include "ui/inputbox.h"
 #include "ui/main.h"
 #include "ui/menu.h"
+#include "ui/profiler.h"
 #include "ui/scanner.h"
 #include "ui/ui.h"
 #include "../misc.h"
@@ -61,6 +63,10 @@ void (*UI_DisplayFunctions[])(void) = {
     [DISPLAY_AIRCOPY] = &UI_DisplayAircopy,
 #endif
 
+#ifdef ENABLE_PROFILER
+    [DISPLAY_PROFILER] = &UI_DisplayProfiler,
+#endif
+
 #ifdef ENABLE_REGA
     [DISPLAY_REGA] = &UI_DisplayREGA,
 #endif
@@ -71,7 +77,7 @@ static_assert(ARRAY_SIZE(UI_DisplayFunctions) == DISPLAY_N_ELEM);
 void GUI_DisplayScreen(void)
 {
     if (gScreenToDisplay != DISPLAY_INVALID) {
-        UI_DisplayFunctions[gScreenToDisplay]();
+        PROFILE(PROFILER_DISPLAY_SCREEN, UI_DisplayFunctions[gScreenToDisplay]());
     }
 }
 